@@ -0,0 +1,373 @@
+#ifndef CONCURRENT_FREELIST_HPP
+#define CONCURRENT_FREELIST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <type_traits>
+
+#include "FreeListStorage.hpp"
+
+// Thread-safe slot pool built on FreeList's slot recycling: emplace() hands
+// out a slot index holding a new payload and erase() gives it back, from
+// any number of threads at once and without locks. There is no list order;
+// it is meant as a shared object pool whose indices are stored elsewhere.
+//
+// Freed slots form a LIFO chain like LifoSlots, but the chain head is a
+// {index, tag} pair updated by compare-and-swap. The tag is bumped on
+// every update, so a thread that read a head which was popped and pushed
+// again in the meantime (the ABA case) fails its CAS instead of corrupting
+// the chain.
+//
+// Slots live in segments that double in size, the first holding
+// 2^SegmentBits slots. Segments are allocated on demand and never move or
+// shrink while the pool exists, so growth does not invalidate indices or
+// references held by other threads. Slot indices are 32 bits wide.
+//
+// Allocator::allocate may be called from several threads at once, so the
+// allocator must be thread-safe, as std::allocator is.
+template<typename T, unsigned SegmentBits = 10, typename Allocator = std::allocator<T>>
+class ConcurrentFreeList {
+    static_assert(SegmentBits > 0 && SegmentBits < 32, "ConcurrentFreeList segment size out of range");
+
+public:
+    using Index = uint32_t;
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    static constexpr Index npos = std::numeric_limits<Index>::max();
+    // Slots a Magazine moves between itself and the pool at a time
+    static constexpr size_t magazineBatch = 32;
+
+private:
+    struct Node {
+        FreeListSlot<T> data;
+        // Next slot in the free chain while free, liveMark while in use
+        std::atomic<Index> next;
+
+        Node() : next(npos) {}
+    };
+
+    struct TaggedIndex {
+        Index index;
+        uint32_t tag;
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+    static_assert(std::atomic<TaggedIndex>::is_always_lock_free,
+                  "ConcurrentFreeList needs a lock-free 64-bit compare-and-swap");
+
+    static constexpr Index liveMark = npos - 1;
+    static constexpr size_t firstSegment = size_t(1) << SegmentBits;
+    static constexpr size_t maxSegments = 33 - SegmentBits;
+
+    // Where slot `index` lives: segment k holds 2^(SegmentBits + k) slots,
+    // so both parts fall out of the position of the highest set bit.
+    static unsigned segmentOf(Index index) {
+        uint64_t shifted = uint64_t(index) + firstSegment;
+        return static_cast<unsigned>(63 - __builtin_clzll(shifted)) - SegmentBits;
+    }
+
+    static size_t offsetOf(Index index, unsigned segment) {
+        return uint64_t(index) + firstSegment - (firstSegment << segment);
+    }
+
+    static size_t segmentSize(unsigned segment) {
+        return firstSegment << segment;
+    }
+
+    Node& node(Index index) const {
+        unsigned segment = segmentOf(index);
+        return segments[segment].load(std::memory_order_acquire)[offsetOf(index, segment)];
+    }
+
+    // Installs segment `segment` unless another thread did so first, in
+    // which case the spare copy is given back.
+    void ensureSegment(unsigned segment) {
+        if (segments[segment].load(std::memory_order_acquire) != nullptr) return;
+
+        NodeAllocator alloc(allocator);
+        size_t count = segmentSize(segment);
+        Node* nodes = NodeTraits::allocate(alloc, count);
+        std::uninitialized_default_construct_n(nodes, count);
+
+        Node* expected = nullptr;
+        if (!segments[segment].compare_exchange_strong(expected, nodes, std::memory_order_acq_rel)) {
+            std::destroy_n(nodes, count);
+            NodeTraits::deallocate(alloc, nodes, count);
+        }
+    }
+
+    // Takes up to `count` free slots into `out` and returns how many it
+    // took, at least one. A run from the top of the free chain is detached
+    // with a single CAS: any push or pop in between bumps the tag, so a
+    // successful CAS proves the walked run was not touched meanwhile. When
+    // the chain is empty, `count` never used slots are taken instead.
+    size_t takeSlots(Index* out, size_t count) {
+        TaggedIndex head = freeHead.load(std::memory_order_acquire);
+
+        while (head.index != npos) {
+            size_t taken = 0;
+            Index next = head.index;
+
+            // A liveMark here means the run was popped meanwhile; the CAS
+            // below is bound to fail, so stop walking
+            while (taken < count && next != npos && next != liveMark) {
+                out[taken++] = next;
+                next = node(next).next.load(std::memory_order_relaxed);
+            }
+
+            if (freeHead.compare_exchange_weak(head, TaggedIndex{next, head.tag + 1},
+                                               std::memory_order_acquire, std::memory_order_acquire)) {
+                return taken;
+            }
+        }
+
+        // The segments are installed before the range is claimed, so a
+        // failed allocation leaves `fresh` untouched and loses no indices
+        Index first = fresh.load(std::memory_order_relaxed);
+        do {
+            if (first >= liveMark - count) {
+                throw std::length_error("ConcurrentFreeList: index type cannot address that many nodes");
+            }
+
+            Index last = static_cast<Index>(first + count - 1);
+            for (unsigned segment = segmentOf(first); segment <= segmentOf(last); ++segment) {
+                ensureSegment(segment);
+            }
+        } while (!fresh.compare_exchange_weak(first, static_cast<Index>(first + count),
+                                              std::memory_order_relaxed, std::memory_order_relaxed));
+
+        for (size_t k = 0; k < count; ++k) {
+            out[k] = static_cast<Index>(first + k);
+        }
+        return count;
+    }
+
+    // Links `count` slots into a chain and pushes it with a single CAS
+    void releaseSlots(const Index* in, size_t count) {
+        for (size_t k = 0; k + 1 < count; ++k) {
+            node(in[k]).next.store(in[k + 1], std::memory_order_relaxed);
+        }
+
+        Node& last = node(in[count - 1]);
+        TaggedIndex head = freeHead.load(std::memory_order_relaxed);
+
+        do {
+            last.next.store(head.index, std::memory_order_relaxed);
+        } while (!freeHead.compare_exchange_weak(head, TaggedIndex{in[0], head.tag + 1},
+                                                 std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Builds a payload in a slot this thread owns and marks the slot live
+    template <typename... Args>
+    void construct(Index index, Args&&... args) {
+        Allocator alloc(allocator);
+        node(index).data.construct(alloc, std::forward<Args>(args)...);
+        node(index).next.store(liveMark, std::memory_order_relaxed);
+    }
+
+    // Destroys the payload of a live slot; the slot stays with the caller
+    void destroy(Index index) {
+        Allocator alloc(allocator);
+        node(index).data.destroy(alloc);
+        node(index).next.store(npos, std::memory_order_relaxed);
+    }
+
+public:
+    ConcurrentFreeList() : ConcurrentFreeList(Allocator()) {}
+
+    explicit ConcurrentFreeList(const Allocator& alloc)
+        : allocator(alloc), freeHead(TaggedIndex{npos, 0}), fresh(0), size_(0) {
+        for (auto& segment : segments) {
+            segment.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ConcurrentFreeList(const ConcurrentFreeList&) = delete;
+    ConcurrentFreeList& operator=(const ConcurrentFreeList&) = delete;
+
+    // Must not race with any other member call
+    ~ConcurrentFreeList() {
+        Allocator alloc(allocator);
+        NodeAllocator nodeAlloc(allocator);
+
+        for (unsigned segment = 0; segment < maxSegments; ++segment) {
+            Node* nodes = segments[segment].load(std::memory_order_acquire);
+            if (nodes == nullptr) continue;
+
+            for (size_t offset = 0; offset < segmentSize(segment); ++offset) {
+                if (nodes[offset].next.load(std::memory_order_relaxed) == liveMark) {
+                    nodes[offset].data.destroy(alloc);
+                }
+            }
+
+            std::destroy_n(nodes, segmentSize(segment));
+            NodeTraits::deallocate(nodeAlloc, nodes, segmentSize(segment));
+        }
+    }
+
+    allocator_type get_allocator() const {
+        return allocator;
+    }
+
+    // Constructs a payload in a free slot and returns the slot's index. The
+    // payload is visible to other threads once the index is handed to them
+    // through any synchronising operation.
+    template <typename... Args>
+    Index emplace(Args&&... args) {
+        Index index = npos;
+        takeSlots(&index, 1);
+
+        try {
+            construct(index, std::forward<Args>(args)...);
+        } catch (...) {
+            releaseSlots(&index, 1);
+            throw;
+        }
+
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    // Destroys the payload in `index` and recycles the slot. Each index
+    // must be erased once, by one thread.
+    void erase(Index index) {
+        destroy(index);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        releaseSlots(&index, 1);
+    }
+
+    T& operator[](Index index) { return node(index).data.get(); }
+    const T& operator[](Index index) const { return node(index).data.get(); }
+
+    // Preallocates the segments covering the first `count` slots, so that
+    // emplace() does not allocate until the pool outgrows them.
+    void reserve(size_t count) {
+        if (count == 0) return;
+
+        size_t last = std::min<size_t>(count, liveMark) - 1;
+        for (unsigned segment = 0; segment <= segmentOf(static_cast<Index>(last)); ++segment) {
+            ensureSegment(segment);
+        }
+    }
+
+    // Snapshot of the number of live payloads; exact once other threads
+    // are quiescent and their Magazines flushed.
+    size_t size() const noexcept {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    // Slots in the segments allocated so far
+    size_t capacity() const noexcept {
+        size_t total = 0;
+        for (unsigned segment = 0; segment < maxSegments; ++segment) {
+            if (segments[segment].load(std::memory_order_relaxed) != nullptr) {
+                total += segmentSize(segment);
+            }
+        }
+        return total;
+    }
+
+    size_t max_size() const noexcept {
+        return liveMark;
+    }
+
+    // Per-thread front end to the pool. Each thread creates its own
+    // Magazine and allocates and frees through it. The Magazine keeps a
+    // small stack of free slot indices, so most operations touch no shared
+    // state at all. An empty Magazine takes magazineBatch slots from the
+    // pool in one CAS. A full one hands the older half back in one CAS,
+    // so a thread that alternates between allocating and freeing at the
+    // boundary does not bounce slots back and forth.
+    //
+    // Any thread may erase any slot: a slot freed by another thread simply
+    // joins the freeing thread's Magazine. Destroying a Magazine, e.g. at
+    // thread exit, returns its slots and publishes its size changes, so no
+    // slot is leaked. Magazines must be destroyed before their pool.
+    class Magazine {
+    public:
+        explicit Magazine(ConcurrentFreeList& pool) : pool(pool), count(0), sizeDelta(0) {}
+
+        Magazine(const Magazine&) = delete;
+        Magazine& operator=(const Magazine&) = delete;
+
+        ~Magazine() {
+            flush();
+        }
+
+        template <typename... Args>
+        Index emplace(Args&&... args) {
+            if (count == 0) {
+                count = pool.takeSlots(slots, magazineBatch);
+                publish();
+            }
+
+            Index index = slots[count - 1];
+            pool.construct(index, std::forward<Args>(args)...);
+            count--;
+            sizeDelta++;
+            return index;
+        }
+
+        void erase(Index index) {
+            pool.destroy(index);
+            sizeDelta--;
+
+            if (count == 2 * magazineBatch) {
+                pool.releaseSlots(slots, magazineBatch);
+                std::move(slots + magazineBatch, slots + count, slots);
+                count -= magazineBatch;
+                publish();
+            }
+
+            slots[count++] = index;
+        }
+
+        T& operator[](Index index) { return pool[index]; }
+        const T& operator[](Index index) const { return pool[index]; }
+
+        // Returns every cached slot to the pool and publishes the size
+        // changes made through this Magazine
+        void flush() {
+            if (count > 0) {
+                pool.releaseSlots(slots, count);
+                count = 0;
+            }
+            publish();
+        }
+
+    private:
+        void publish() {
+            pool.size_.fetch_add(static_cast<size_t>(sizeDelta), std::memory_order_relaxed);
+            sizeDelta = 0;
+        }
+
+        ConcurrentFreeList& pool;
+        Index slots[2 * magazineBatch];
+        size_t count;
+        // Emplaces minus erases not yet added to the pool's size
+        std::ptrdiff_t sizeDelta;
+    };
+
+private:
+    Allocator allocator;
+    std::atomic<Node*> segments[maxSegments];
+    std::atomic<TaggedIndex> freeHead;
+    // Slots below `fresh` have been taken from a segment at least once
+    std::atomic<Index> fresh;
+    std::atomic<size_t> size_;
+};
+
+#endif
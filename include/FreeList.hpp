@@ -2,164 +2,670 @@
 #define FREELIST_HPP
 
 #include <vector>
+#include <algorithm>
 #include <iterator>
 #include <limits>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+#include <tuple>
+#include <memory>
+#include <memory_resource>
+// sort(policy, comp) is opt-in: define FREELIST_PARALLEL_SORT before
+// including this header to get it. libstdc++ runs the parallel algorithms
+// on TBB, so programs that opt in must then link with -ltbb.
+#if defined(FREELIST_PARALLEL_SORT) && __has_include(<execution>)
+#include <execution>
+#endif
+
+#include "FreeListStorage.hpp"
+#include "FreeListSlots.hpp"
+
+// std::is_execution_policy when the parallel sort is enabled and the
+// standard library has the parallel algorithms, false everywhere else
+#if defined(FREELIST_PARALLEL_SORT) && defined(__cpp_lib_execution)
+template <typename Policy>
+struct FreeListIsPolicy : std::is_execution_policy<Policy> {};
+#else
+template <typename Policy>
+struct FreeListIsPolicy : std::false_type {};
+#endif
 
-template<typename T>
+// `Index` is the unsigned type used for the links between nodes. A narrower
+// type such as uint32_t shrinks every node, at the cost of a lower max_size().
+// `StoragePolicy` picks the slot layout, see FreeListStorage.hpp.
+// `SlotPolicy` picks which free slot a new node reuses, see FreeListSlots.hpp.
+// `Allocator` supplies all of the list's memory and is propagated through
+// copy, move and swap like a standard container's; see PmrFreeList below.
+template<typename T, typename Index = size_t, typename StoragePolicy = InterleavedStorage,
+         typename SlotPolicy = LifoSlots, typename Allocator = std::allocator<T>>
 class FreeList {
+    static_assert(std::is_unsigned<Index>::value, "FreeList index type must be unsigned");
+
+public:
+    static constexpr Index npos = std::numeric_limits<Index>::max();
+    static constexpr size_t defaultPrefetchDistance = 8;
+    static constexpr size_t maxPrefetchDistance = 64;
+    // Below this many elements sort(policy, ...) uses the sequential merge
+    // sort; gathering and relinking would cost more than they save.
+    static constexpr size_t parallelSortThreshold = size_t(1) << 16;
+
 private:
-    struct Node {
-        T data;
-        size_t next;
-        size_t prev;
-        size_t nextFree;
-
-        Node(const T& data) : data(data), next(SIZE_MAX), prev(SIZE_MAX), nextFree(SIZE_MAX) {}
-        Node(T&& data) : data(std::move(data)), next(SIZE_MAX), prev(SIZE_MAX), nextFree(SIZE_MAX) {}
-        Node() : data(T{}), next(SIZE_MAX), prev(SIZE_MAX), nextFree(SIZE_MAX) {}
-        ~Node() = default;
-
-        Node(const Node&) = default;
-        Node(Node&&) noexcept = default;
-        Node& operator=(const Node&) = default;
-        Node& operator=(Node&&) noexcept = default;
-    };
+    template <typename U>
+    using Rebind = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+
+    using Storage = typename StoragePolicy::template type<T, Index, Allocator>;
+    using Link = typename Storage::Link;
+    using Slots = typename SlotPolicy::template type<Index, Allocator>;
+
+    static constexpr size_t bitsPerWord = 64;
+    static constexpr uint64_t fullWord = ~uint64_t(0);
+
+    // Slot generations are 32 bits whatever `Index` is, so a narrow index
+    // type does not make them wrap after a few hundred frees of one slot
+    using Generation = uint32_t;
 
-    std::vector<Node> nodes;
-    size_t head;
-    size_t tail;
-    size_t freeHead;
+    template <typename U, size_t SlotsPerEntry>
+    using SideTable = typename FreeListSideTable<Storage, U, SlotsPerEntry, Rebind<U>>::type;
+    using Bitmap = SideTable<uint64_t, bitsPerWord>;
+
+    Storage nodes;
+    Index head;
+    Index tail;
+    Slots slots;
     size_t size_;
+    // Slot of the node compact_step() placed last. Every change to the
+    // list's nodes or order resets it, since the placed prefix no longer
+    // matches the list after one.
+    Index compactCursor;
+    // One bit per slot, set while the slot holds a live node. Lets the
+    // *_unordered scans walk storage densely instead of following links.
+    Bitmap live;
+    // Per-slot generation, bumped whenever the slot's node is freed or
+    // moved, so Handles to the old occupant stop matching. Never shrinks,
+    // so a slot index is only paired with a generation it had before once
+    // that slot's 32-bit counter wraps.
+    SideTable<Generation, 1> generations;
+
+    // Grows the liveness bitmap, the generation table and the slot
+    // policy's free set to cover the first `count` slots. Called before a
+    // payload is constructed in a fresh slot, so that marking it live
+    // afterwards and freeing it later cannot throw.
+    void reserveMarks(size_t count) {
+        slots.reserve(nodes, count);
+
+        size_t words = (count + bitsPerWord - 1) / bitsPerWord;
+
+        if (words > live.size()) {
+            live.resize(std::max(words, live.size() * 2), 0);
+        }
 
-    template <typename U>
-    size_t allocateNode(U&& data) {
-        size_t index;
+        if (count > generations.size()) {
+            generations.resize(count, 0);
+        }
+    }
+
+    void markLive(Index index) noexcept {
+        live[index / bitsPerWord] |= uint64_t(1) << (index % bitsPerWord);
+    }
+
+    void markDead(Index index) {
+        live[index / bitsPerWord] &= ~(uint64_t(1) << (index % bitsPerWord));
+        generations[index]++;
+    }
+
+    // Calls visit(index) for every live slot in storage order. Fully live
+    // words run as a plain counted loop the compiler can vectorise.
+    template <typename Visit>
+    void visitLive(Visit visit) const {
+        for (size_t word = 0; word < live.size(); ++word) {
+            uint64_t bits = live[word];
+            Index base = static_cast<Index>(word * bitsPerWord);
+
+            if (bits == fullWord) {
+                for (Index offset = 0; offset < bitsPerWord; ++offset) {
+                    visit(base + offset);
+                }
+                continue;
+            }
+
+            while (bits != 0) {
+                visit(base + static_cast<Index>(__builtin_ctzll(bits)));
+                bits &= bits - 1;
+            }
+        }
+    }
 
-        if (freeHead != SIZE_MAX) {
-            index = freeHead;
-            freeHead = nodes[freeHead].nextFree;
-            nodes[index] = Node(std::forward<T>(data));
+    // First live slot in storage order for which match(index) holds, or
+    // npos. Fully live words are tested as a whole before looking for the
+    // matching slot, keeping the common no-match case branch free.
+    template <typename Match>
+    Index findLive(Match match) const {
+        for (size_t word = 0; word < live.size(); ++word) {
+            uint64_t bits = live[word];
+            Index base = static_cast<Index>(word * bitsPerWord);
+
+            if (bits == fullWord) {
+                bool any = false;
+                for (Index offset = 0; offset < bitsPerWord; ++offset) {
+                    any |= match(base + offset);
+                }
+                if (!any) continue;
+            }
+
+            while (bits != 0) {
+                Index index = base + static_cast<Index>(__builtin_ctzll(bits));
+                if (match(index)) return index;
+                bits &= bits - 1;
+            }
+        }
+
+        return npos;
+    }
+
+    // npos is reserved as the end sentinel, so at most npos slots exist
+    void checkGrowth(size_t count) const {
+        if (count > max_size() - nodes.size()) {
+            throw std::length_error("FreeList: index type cannot address that many nodes");
+        }
+    }
+
+    // Constructs the payload directly in its final slot; no temporary T or
+    // node is created on the way. `hint` is the node the new one will sit
+    // next to in the list and steers the slot policy's choice.
+    template <typename... Args>
+    Index allocateNode(Index hint, Args&&... args) {
+        Index index;
+
+        if (!slots.empty()) {
+            index = slots.pick(nodes, hint);
+            nodes.construct(index, std::forward<Args>(args)...);
+            slots.acquire(nodes, index);
+            link(index) = Link();
         } else {
-            index = nodes.size();
-            nodes.emplace_back(std::forward<T>(data));
+            checkGrowth(1);
+            reserveMarks(nodes.size() + 1);
+            index = nodes.emplace_back(std::forward<Args>(args)...);
         }
 
+        markLive(index);
         size_++;
         return index;
     }
 
-    size_t allocateNode(const T& data) {
-        size_t index;
+    // Allocates `count` nodes as one detached chain, taking free slots first
+    // and then fresh storage reserved up front. `source()` yields a tuple of
+    // constructor arguments for each payload. `hint` seeds the slot policy
+    // and each later node is placed near its predecessor in the chain.
+    // Returns the {first, last} nodes of the chain, or npos for both when
+    // `count` is zero.
+    template <typename Source>
+    std::pair<Index,Index> allocateChain(size_t count, Index hint, Source source) {
+        Index first = npos;
+        Index last = npos;
+
+        auto append = [&](Index index) {
+            link(index).prev = last;
+            link(index).next = npos;
+
+            if (last == npos) {
+                first = index;
+            } else {
+                link(last).next = index;
+            }
+
+            last = index;
+            markLive(index);
+            size_++;
+        };
+
+        try {
+            size_t built = 0;
+
+            for (; built < count && !slots.empty(); ++built) {
+                Index index = slots.pick(nodes, (last == npos) ? hint : last);
+                std::apply([&](auto&&... args) {
+                    nodes.construct(index, std::forward<decltype(args)>(args)...);
+                }, source());
+                slots.acquire(nodes, index);
+                append(index);
+            }
+
+            if (built < count) {
+                checkGrowth(count - built);
 
-        if (freeHead != SIZE_MAX) {
-            index = freeHead;
-            freeHead = nodes[freeHead].nextFree;
-            nodes[index] = Node(data);
-        } else {
-            index = nodes.size();
-            nodes.emplace_back(data);
+                size_t needed = nodes.size() + (count - built);
+                if (needed > nodes.capacity()) {
+                    nodes.reserve(std::max(needed, nodes.capacity() * 2));
+                }
+                reserveMarks(needed);
+            }
+
+            for (; built < count; ++built) {
+                append(std::apply([&](auto&&... args) {
+                    return nodes.emplace_back(std::forward<decltype(args)>(args)...);
+                }, source()));
+            }
+        } catch (...) {
+            if (first != npos) {
+                releaseRange(first, last);
+            }
+            throw;
         }
 
-        size_++;
+        return {first, last};
+    }
 
-        return index;
+    // Links a chain from allocateChain() in front of `pos` and returns its
+    // first node, or `pos` when the chain is empty.
+    Index spliceChain(Index pos, std::pair<Index,Index> chain) {
+        if (chain.first == npos) return pos;
+
+        linkRangeBefore(pos, chain.first, chain.second);
+        return chain.first;
     }
 
-    void remove(size_t index) {
-        if (index >= nodes.size()) return;
+    // Leaves a list whose contents were moved out in the empty state. The
+    // storage has already handed over or destroyed every payload.
+    void resetMovedFrom() noexcept {
+        head = tail = compactCursor = npos;
+        size_ = 0;
+        slots.clear();
+        live.clear();
+    }
+
+    // Slot next to which a node inserted in front of `pos` will be linked
+    Index neighbour(Index pos) const {
+        return (pos == npos) ? tail : pos;
+    }
+
+    // Links a freshly allocated node in front of `pos`, or at the tail when
+    // `pos` is npos.
+    void linkBefore(Index pos, Index index) {
+        compactCursor = npos;
+        Index prevIndex = (pos == npos) ? tail : link(pos).prev;
+
+        link(index).next = pos;
+        link(index).prev = prevIndex;
+
+        if (prevIndex == npos) {
+            head = index;
+        } else {
+            link(prevIndex).next = index;
+        }
 
-        size_t nextIndex = nodes[index].next;
-        size_t prevIndex = nodes[index].prev;
+        if (pos == npos) {
+            tail = index;
+        } else {
+            link(pos).prev = index;
+        }
+    }
 
-        if (prevIndex == SIZE_MAX) {
+    void remove(Index index) {
+        if (index >= nodes.size() || isFree(index)) return;
+
+        compactCursor = npos;
+        Index nextIndex = link(index).next;
+        Index prevIndex = link(index).prev;
+
+        if (prevIndex == npos) {
             head = nextIndex;
         } else {
-            nodes[prevIndex].next = nextIndex;
+            link(prevIndex).next = nextIndex;
         }
 
-        if (nextIndex == SIZE_MAX) {
+        if (nextIndex == npos) {
             tail = prevIndex;
         } else {
-            nodes[nextIndex].prev = prevIndex;
+            link(nextIndex).prev = prevIndex;
         }
 
-        nodes[index].nextFree = freeHead;
-        freeHead = index;
+        nodes.destroy(index);
+        link(index).prev = index;
+        slots.release(nodes, index);
+        markDead(index);
 
         size_--;
     }
 
-    template <typename Compare = std::less<T> >
-    size_t merge(const size_t first, const size_t second, size_t& tail, const Compare& comp = Compare()) {
-        if (first == SIZE_MAX) return second;
-        if (second == SIZE_MAX) return first;
+    Link& link(Index index) { return nodes.link(index); }
+    const Link& link(Index index) const { return nodes.link(index); }
 
-        size_t result = SIZE_MAX;
+    T& value(Index index) { return nodes.value(index); }
+    const T& value(Index index) const { return nodes.value(index); }
 
-        if (comp(nodes[first].data, nodes[second].data)) {
-            result = first;
+    // Detaches the chain first..last (both inclusive) from the list, leaving
+    // the links inside the chain untouched.
+    void unlinkRange(Index first, Index last) {
+        compactCursor = npos;
+        Index before = link(first).prev;
+        Index after = link(last).next;
 
-            nodes[first].next = merge(nodes[first].next, second, tail, comp);
-            if (nodes[first].next != SIZE_MAX) {
-                nodes[nodes[first].next].prev = first;
-            } else {
-                tail = first;
-            }
-            nodes[first].prev = SIZE_MAX;
+        if (before == npos) {
+            head = after;
+        } else {
+            link(before).next = after;
+        }
+
+        if (after == npos) {
+            tail = before;
+        } else {
+            link(after).prev = before;
+        }
+    }
+
+    // Links a detached chain first..last in front of `pos`, or at the tail
+    // when `pos` is npos.
+    void linkRangeBefore(Index pos, Index first, Index last) {
+        compactCursor = npos;
+        Index before = (pos == npos) ? tail : link(pos).prev;
+
+        link(first).prev = before;
+        link(last).next = pos;
+
+        if (before == npos) {
+            head = first;
+        } else {
+            link(before).next = first;
+        }
+
+        if (pos == npos) {
+            tail = last;
+        } else {
+            link(pos).prev = last;
+        }
+    }
+
+    // Returns the detached chain first..last (both inclusive) to the slot
+    // policy as one batch. Each node only has its payload destroyed and its
+    // tag set here; the chain's next links are left for releaseRun().
+    size_t releaseRange(Index first, Index last) {
+        size_t count = 0;
+
+        for (Index curr = first;; curr = link(curr).next) {
+            nodes.destroy(curr);
+            link(curr).prev = curr;
+            markDead(curr);
+            count++;
+
+            if (curr == last) break;
+        }
+
+        slots.releaseRun(nodes, first, last);
+        size_ -= count;
+
+        return count;
+    }
+
+    bool isFree(Index index) const {
+        return link(index).prev == index;
+    }
+
+    static constexpr size_t cacheLine = 64;
+    static constexpr size_t maxPrefetchBytes = 4 * cacheLine;
+    static constexpr size_t prefetchGroup = 8;
+
+    // Requests the payload of a live node ahead of use. Only the first few
+    // cache lines of large payloads are touched.
+    void prefetch(Index index) const {
+        const char* bytes = reinterpret_cast<const char*>(&value(index));
+
+        for (size_t offset = 0; offset < sizeof(T) && offset < maxPrefetchBytes; offset += cacheLine) {
+            __builtin_prefetch(bytes + offset);
+        }
+    }
+
+    // Exchanges the storage slots of two live nodes, rewriting every link
+    // that referred to either of them.
+    void swapSlots(Index a, Index b) {
+        auto swapped = [a, b](Index index) {
+            return (index == a) ? b : (index == b) ? a : index;
+        };
+
+        Index neighbours[4] = {
+            link(a).prev, link(a).next, link(b).prev, link(b).next
+        };
+
+        nodes.swap_slots(a, b);
+
+        link(a).prev = swapped(link(a).prev);
+        link(a).next = swapped(link(a).next);
+        link(b).prev = swapped(link(b).prev);
+        link(b).next = swapped(link(b).next);
+
+        for (size_t i = 0; i < 4; ++i) {
+            Index n = neighbours[i];
+            if (n == npos || n == a || n == b) continue;
+            if (std::find(neighbours, neighbours + i, n) != neighbours + i) continue;
+
+            link(n).prev = swapped(link(n).prev);
+            link(n).next = swapped(link(n).next);
+        }
+
+        head = swapped(head);
+        tail = swapped(tail);
+
+        generations[a]++;
+        generations[b]++;
+    }
+
+    // Stable merge of two next-linked runs; `left` wins ties.
+    template <typename Compare>
+    Index merge(Index left, Index right, const Compare& comp) {
+        if (left == npos) return right;
+        if (right == npos) return left;
+
+        Index result;
+        if (comp(value(right), value(left))) {
+            result = right;
+            right = link(right).next;
         } else {
-            result = second;
+            result = left;
+            left = link(left).next;
+        }
 
-            nodes[second].next = merge(first, nodes[second].next, tail, comp);
-            if (nodes[second].next != SIZE_MAX) {
-                nodes[nodes[second].next].prev = second;
+        Index last = result;
+        while (left != npos && right != npos) {
+            if (comp(value(right), value(left))) {
+                link(last).next = right;
+                last = right;
+                right = link(right).next;
             } else {
-                tail = second;
+                link(last).next = left;
+                last = left;
+                left = link(left).next;
             }
-            nodes[second].prev = SIZE_MAX;
         }
+
+        link(last).next = (left != npos) ? left : right;
         return result;
     }
 
-    std::pair<size_t,size_t> split(const size_t start, const size_t end) {
-        if (start == end) return {start, start};
+    // Bottom-up merge sort over the chain starting at `first`. Nodes are
+    // merged into a fixed set of bins holding runs of doubling length (the
+    // same scheme std::list::sort uses), so the sort is iterative, stable and
+    // needs O(1) extra space. Only next is maintained while merging; prev is
+    // rebuilt in one final pass. Returns the new {head, tail} of the chain.
+    template <typename Compare = std::less<T> >
+    std::pair<Index,Index> mergeSort(Index first, const Compare& comp = Compare()) {
+        if (first == npos) return {npos, npos};
+
+        compactCursor = npos;
+        constexpr size_t maxBins = std::numeric_limits<Index>::digits;
+        Index bins[maxBins];
+        size_t usedBins = 0;
+
+        while (first != npos) {
+            Index run = first;
+            first = link(first).next;
+            link(run).next = npos;
+
+            size_t bin = 0;
+            for (; bin < usedBins && bins[bin] != npos; ++bin) {
+                run = merge(bins[bin], run, comp);
+                bins[bin] = npos;
+            }
 
-        size_t slow = start;
-        size_t fast = start;
+            if (bin == usedBins) {
+                usedBins++;
+            }
+            bins[bin] = run;
+        }
 
-        while (fast != end && nodes[fast].next != end) {
-            slow = nodes[slow].next;
-            fast = nodes[nodes[fast].next].next;
+        Index result = npos;
+        for (size_t bin = 0; bin < usedBins; ++bin) {
+            result = merge(bins[bin], result, comp);
         }
 
-        size_t second_half = nodes[slow].next;
-        nodes[slow].next = SIZE_MAX;
+        Index prev = npos;
+        Index last = result;
+        for (Index curr = result; curr != npos; curr = link(curr).next) {
+            link(curr).prev = prev;
+            prev = last = curr;
+        }
 
-        if (second_half != SIZE_MAX) {
-            nodes[second_half].prev = SIZE_MAX;
+        return {result, last};
+    }
+
+    // Relinks the whole list in the order given by `at(0) .. at(count - 1)`
+    // in one linear pass.
+    template <typename At>
+    void relinkInOrder(size_t count, At at) {
+        compactCursor = npos;
+        Index prev = npos;
+
+        for (size_t k = 0; k < count; ++k) {
+            Index curr = at(k);
+            link(curr).prev = prev;
+            link(curr).next = (k + 1 == count) ? npos : at(k + 1);
+            prev = curr;
         }
-        return {second_half,slow};
+
+        head = (count == 0) ? npos : at(0);
+        tail = prev;
     }
 
-    template <typename Compare = std::less<T> >
-    size_t mergeSort(size_t start, size_t end, const Compare& comp = Compare()) {
-        if (start == SIZE_MAX || start == end) return start;
+#if defined(FREELIST_PARALLEL_SORT) && defined(__cpp_lib_execution)
+    // Gathers the live nodes in list order into a contiguous buffer, sorts
+    // it with `policy` and relinks the list to match. Small trivially
+    // copyable payloads are copied next to their index so the sort works on
+    // dense keys; anything else is sorted through its index. The sort is
+    // stable, like the merge sort.
+    template <typename ExecutionPolicy, typename Compare>
+    void sortGathered(ExecutionPolicy&& policy, const Compare& comp) {
+        if constexpr (std::is_trivially_copyable<T>::value && sizeof(T) <= 16) {
+            std::vector<std::pair<T, Index>> keyed;
+            keyed.reserve(size_);
+
+            for (Index curr = head; curr != npos; curr = link(curr).next) {
+                keyed.emplace_back(value(curr), curr);
+            }
 
-        auto [second_half_start, start_end] = split(start, end);
+            std::stable_sort(policy, keyed.begin(), keyed.end(),
+                             [&comp](const std::pair<T, Index>& a, const std::pair<T, Index>& b) {
+                                 return comp(a.first, b.first);
+                             });
 
-        start = mergeSort(start, start_end, comp);
-        second_half_start = mergeSort(second_half_start, end, comp);
+            relinkInOrder(keyed.size(), [&keyed](size_t k) { return keyed[k].second; });
+        } else {
+            std::vector<Index> order;
+            order.reserve(size_);
 
-        size_t _tail = SIZE_MAX;
-        size_t _head = merge(start, second_half_start, _tail, comp);
-        tail = _tail;
+            for (Index curr = head; curr != npos; curr = link(curr).next) {
+                order.push_back(curr);
+            }
 
-        return _head;
+            std::stable_sort(policy, order.begin(), order.end(),
+                             [this, &comp](Index a, Index b) { return comp(value(a), value(b)); });
+
+            relinkInOrder(order.size(), [&order](size_t k) { return order[k]; });
+        }
+    }
+#endif
+
+    // Below this many elements the comparison sort beats radix_sort's fixed
+    // histogram and buffer costs.
+    static constexpr size_t radixSortThreshold = 64;
+
+    // Maps an integral key to an unsigned value with the same ordering
+    template <typename Key>
+    static auto radixBits(Key key) {
+        using Bits = std::make_unsigned_t<std::conditional_t<std::is_same<Key, bool>::value, uint8_t, Key>>;
+        Bits bits = static_cast<Bits>(key);
+
+        if constexpr (std::is_signed<Key>::value) {
+            bits ^= Bits(1) << (sizeof(Bits) * 8 - 1);
+        }
+        return bits;
+    }
+
+    // LSD radix sort of the whole list by `key`, one byte per pass, over a
+    // buffer of {key, index} entries gathered in list order. Each pass is a
+    // stable counting sort, so equal keys keep their list order; descending
+    // order sorts the complemented keys. Passes in which every key shares
+    // the same byte are skipped.
+    template <typename KeyExtractor>
+    void radixSort(KeyExtractor& key, bool descending) {
+        using Key = std::decay_t<decltype(key(std::declval<const T&>()))>;
+        static_assert(std::is_integral<Key>::value, "radix_sort needs an integral key");
+        using Bits = decltype(radixBits(std::declval<Key>()));
+
+        struct Entry {
+            Bits key;
+            Index index;
+        };
+
+        constexpr size_t radix = 256;
+        constexpr size_t passes = sizeof(Bits);
+
+        std::vector<Entry> entries;
+        entries.reserve(size_);
+
+        std::vector<size_t> counts(passes * radix, 0);
+
+        for (Index curr = head; curr != npos; curr = link(curr).next) {
+            Bits bits = radixBits(key(value(curr)));
+            if (descending) {
+                bits = static_cast<Bits>(~bits);
+            }
+
+            entries.push_back({bits, curr});
+            for (size_t pass = 0; pass < passes; ++pass) {
+                counts[pass * radix + ((bits >> (pass * 8)) & 0xFF)]++;
+            }
+        }
+
+        std::vector<Entry> buffer(entries.size());
+
+        for (size_t pass = 0; pass < passes; ++pass) {
+            size_t* digits = &counts[pass * radix];
+
+            if (std::find(digits, digits + radix, entries.size()) != digits + radix) {
+                continue;
+            }
+
+            size_t offset = 0;
+            for (size_t digit = 0; digit < radix; ++digit) {
+                size_t count = digits[digit];
+                digits[digit] = offset;
+                offset += count;
+            }
+
+            for (const Entry& entry : entries) {
+                buffer[digits[(entry.key >> (pass * 8)) & 0xFF]++] = entry;
+            }
+            entries.swap(buffer);
+        }
+
+        relinkInOrder(entries.size(), [&entries](size_t k) { return entries[k].index; });
     }
 
 public:
     using value_type = T;
+    using allocator_type = Allocator;
 
     class Iterator {
 	friend class FreeList;
@@ -172,12 +678,12 @@ public:
         using pointer = T*;
         using reference = T&;
 
-        Iterator() : list(nullptr), index(SIZE_MAX) {}
+        Iterator() : list(nullptr), index(npos) {}
 
-        Iterator(FreeList* list, size_t index)
+        Iterator(FreeList* list, Index index)
             : list(list), index(index) {}
 
-        Iterator(const FreeList* list, size_t index)
+        Iterator(const FreeList* list, Index index)
             : list(const_cast<FreeList*>(list)), index(index) {}
 
         Iterator(const Iterator&) = default;
@@ -186,24 +692,24 @@ public:
         Iterator& operator=(Iterator&&) noexcept = default;
 
         reference operator*() {
-            return list->nodes[index].data;
+            return list->value(index);
         }
 
         reference operator*() const {
-            return list->nodes[index].data;
+            return list->value(index);
         }
 
         pointer operator->() {
-            return &list->nodes[index].data;
+            return &list->value(index);
         }
 
         const pointer operator->() const {
-            return &list->nodes[index].data;
+            return &list->value(index);
         }
 
 
         Iterator& operator++() {
-            index = list->nodes[index].next;
+            index = list->link(index).next;
             return *this;
         }
 
@@ -214,10 +720,10 @@ public:
         }
 
         Iterator& operator--() {
-	    if (index == SIZE_MAX) {
+	    if (index == npos) {
             index = list->tail;
 	    } else {
-            index = list->nodes[index].prev;
+            index = list->link(index).prev;
 	    }
             return *this;
         }
@@ -238,7 +744,7 @@ public:
 
     private:
 
-        size_t getIndex() const {
+        Index getIndex() const {
             return index;
         }
 
@@ -247,7 +753,7 @@ public:
 	}
 	
         FreeList* list;
-        size_t index;
+        Index index;
     };
 
     class ConstIterator {
@@ -259,9 +765,9 @@ public:
 	using pointer = const T*;
 	using reference = const T&;
 
-	ConstIterator() : list(nullptr), index(SIZE_MAX) {}
+	ConstIterator() : list(nullptr), index(npos) {}
 
-	ConstIterator(const FreeList* list, size_t index)
+	ConstIterator(const FreeList* list, Index index)
 	    : list(list), index(index) {}
 
 	ConstIterator(const Iterator& it)
@@ -273,15 +779,15 @@ public:
 	ConstIterator& operator=(ConstIterator&&) noexcept = default;
 
 	reference operator*() const {
-	    return list->nodes[index].data;
+	    return list->value(index);
 	}
 
 	pointer operator->() const {
-	    return &list->nodes[index].data;
+	    return &list->value(index);
 	}
 
 	ConstIterator& operator++() {
-	    index = list->nodes[index].next;
+	    index = list->link(index).next;
 	    return *this;
 	}
 
@@ -292,10 +798,10 @@ public:
 	}
 
 	ConstIterator& operator--() {
-	    if (index == SIZE_MAX) {
+	    if (index == npos) {
             index = list->tail;
 	    } else {
-            index = list->nodes[index].prev;
+            index = list->link(index).prev;
 	    }
 	    return *this;
 	}
@@ -316,12 +822,84 @@ public:
 
     private:
 
-	size_t getIndex() const {
+	Index getIndex() const {
 	    return index;
 	}
 
         const FreeList* list;
-        size_t index;
+        Index index;
+    };
+
+    // Forward iterator that keeps a second cursor `distance` hops ahead and
+    // prefetches the payload under it, so the payload is usually in cache
+    // by the time the iterator reaches it. Compares equal to another
+    // PrefetchIterator at the same node.
+    class PrefetchIterator {
+	friend class FreeList;
+    public:
+	using iterator_category = std::forward_iterator_tag;
+	using difference_type = std::ptrdiff_t;
+	using value_type = T;
+	using pointer = T*;
+	using reference = T&;
+
+	PrefetchIterator() : list(nullptr), index(npos), ahead(npos) {}
+
+	reference operator*() const {
+	    return list->value(index);
+	}
+
+	pointer operator->() const {
+	    return &list->value(index);
+	}
+
+	PrefetchIterator& operator++() {
+	    index = list->link(index).next;
+
+	    if (ahead != npos) {
+		ahead = list->link(ahead).next;
+		if (ahead != npos) {
+		    list->prefetch(ahead);
+		}
+	    }
+	    return *this;
+	}
+
+	PrefetchIterator operator++(int) {
+	    PrefetchIterator temp = *this;
+	    ++(*this);
+	    return temp;
+	}
+
+	bool operator==(const PrefetchIterator& other) const {
+	    return (index == other.index) && (list == other.list);
+	}
+
+	bool operator!=(const PrefetchIterator& other) const {
+	    return !(*this == other);
+	}
+
+    private:
+	PrefetchIterator(FreeList* list, Index index, size_t distance)
+	    : list(list), index(index), ahead(index) {
+	    for (size_t hop = 0; hop < distance && ahead != npos; ++hop) {
+		list->prefetch(ahead);
+		ahead = list->link(ahead).next;
+	    }
+	}
+
+        FreeList* list;
+        Index index;
+        Index ahead;
+    };
+
+    // begin()/end() pair of PrefetchIterators for range-for loops
+    struct PrefetchRange {
+        PrefetchIterator first;
+        PrefetchIterator last;
+
+        PrefetchIterator begin() const { return first; }
+        PrefetchIterator end() const { return last; }
     };
 
     using iterator = Iterator;
@@ -329,13 +907,30 @@ public:
     using reverse_iterator = std::reverse_iterator<iterator>;
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+    // Stable reference to an element: its slot plus the slot's generation
+    // when the handle was taken. Unlike an iterator, a handle to an erased
+    // or relocated element is detected instead of aliasing whatever reuses
+    // the slot. 8 bytes with uint32_t or narrower indices.
+    struct Handle {
+        Index index;
+        Generation generation;
+
+        bool operator==(const Handle& other) const {
+            return index == other.index && generation == other.generation;
+        }
+
+        bool operator!=(const Handle& other) const {
+            return !(*this == other);
+        }
+    };
+
     iterator begin() { return iterator(this, head); }
     const_iterator begin() const { return const_iterator(this, head); }
     const_iterator cbegin() const noexcept { return const_iterator(this, head); }
 
-    iterator end() { return iterator(this, SIZE_MAX); }
-    const_iterator end() const { return const_iterator(this, SIZE_MAX); }
-    const_iterator cend() const noexcept { return const_iterator(this, SIZE_MAX); }
+    iterator end() { return iterator(this, npos); }
+    const_iterator end() const { return const_iterator(this, npos); }
+    const_iterator cend() const noexcept { return const_iterator(this, npos); }
 
     reverse_iterator rbegin() { return reverse_iterator(end()); }
     const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
@@ -345,135 +940,212 @@ public:
     const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
     const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
 
-    FreeList() : nodes(), head(SIZE_MAX), tail(SIZE_MAX), freeHead(SIZE_MAX), size_(0) {}
+    FreeList() : FreeList(Allocator()) {}
 
-    FreeList(size_t count) : FreeList() {
-        for (size_t i = 0; i < count; ++i) {
-            push_back(T{});
-        }
+    explicit FreeList(const Allocator& alloc)
+        : nodes(alloc), head(npos), tail(npos), slots(alloc), size_(0), compactCursor(npos),
+          live(alloc), generations(alloc) {}
+
+    FreeList(size_t count, const Allocator& alloc = Allocator()) : FreeList(alloc) {
+        allocate_n(cend(), count);
     }
 
-    FreeList(size_t count, const T& value) : FreeList() {
-        for (size_t i = 0; i < count; ++i) {
-            push_back(value);
-        }
+    FreeList(size_t count, const T& value, const Allocator& alloc = Allocator()) : FreeList(alloc) {
+        insert(cend(), count, value);
     }
 
-    FreeList(const_iterator first, const_iterator last) : FreeList() {
-        for (auto it = first; it != last; ++it) {
-            push_back(*it);
-        }
+    FreeList(const_iterator first, const_iterator last, const Allocator& alloc = Allocator()) : FreeList(alloc) {
+        insert(cend(), first, last);
     }
 
-    FreeList(std::initializer_list<T> init) : FreeList() {
-        for (const auto& value : init) {
-            push_back(value);
-        }
+    FreeList(std::initializer_list<T> init, const Allocator& alloc = Allocator()) : FreeList(alloc) {
+        insert(cend(), init.begin(), init.end());
     }
 
     ~FreeList() = default;
 
     FreeList(const FreeList& other) = default;
-    FreeList(FreeList&& other) noexcept = default;
     FreeList& operator=(const FreeList& other) = default;
-    FreeList& operator=(FreeList&& other) noexcept = default;
 
-    template <typename Compare = std::less<T> >
+    // Moved-from lists are left empty, also when the storage had to move
+    // element by element because the allocators differ.
+    FreeList(FreeList&& other) noexcept(std::is_nothrow_move_constructible<Storage>::value)
+        : nodes(std::move(other.nodes)), head(other.head), tail(other.tail), slots(std::move(other.slots)),
+          size_(other.size_), compactCursor(other.compactCursor),
+          live(std::move(other.live)), generations(std::move(other.generations)) {
+        other.resetMovedFrom();
+    }
+
+    FreeList& operator=(FreeList&& other) noexcept(std::is_nothrow_move_assignable<Storage>::value) {
+        if (this != &other) {
+            nodes = std::move(other.nodes);
+            head = other.head;
+            tail = other.tail;
+            slots = std::move(other.slots);
+            size_ = other.size_;
+            compactCursor = other.compactCursor;
+            live = std::move(other.live);
+            generations = std::move(other.generations);
+            other.resetMovedFrom();
+        }
+        return *this;
+    }
+
+    // Allocator-extended copy and move, which uses-allocator construction
+    // relies on when lists are nested inside the payloads of other lists.
+    // Moving to an unequal allocator moves the elements one by one.
+    FreeList(const FreeList& other, const Allocator& alloc)
+        : nodes(other.nodes, alloc), head(other.head), tail(other.tail), slots(other.slots, alloc),
+          size_(other.size_), compactCursor(other.compactCursor),
+          live(other.live, alloc), generations(other.generations, alloc) {}
+
+    FreeList(FreeList&& other, const Allocator& alloc)
+        : nodes(std::move(other.nodes), alloc), head(other.head), tail(other.tail),
+          slots(std::move(other.slots), alloc), size_(other.size_), compactCursor(other.compactCursor),
+          live(std::move(other.live), alloc), generations(std::move(other.generations), alloc) {
+        other.resetMovedFrom();
+    }
+
+    allocator_type get_allocator() const {
+        return nodes.get_allocator();
+    }
+
+    // Integral lists ordered by std::less or std::greater are radix sorted;
+    // everything else goes through the merge sort.
+    template <typename Compare = std::less<T>,
+              typename = std::enable_if_t<!FreeListIsPolicy<Compare>::value &&
+                                          !std::is_convertible<Compare, const_iterator>::value>>
     void sort(const Compare& comp = Compare()) {
         if (empty()) return;
 
-        head = mergeSort(head, tail, comp);
+        if constexpr (std::is_integral<T>::value) {
+            constexpr bool ascending = std::is_same<Compare, std::less<T>>::value ||
+                                       std::is_same<Compare, std::less<>>::value;
+            constexpr bool descending = std::is_same<Compare, std::greater<T>>::value ||
+                                        std::is_same<Compare, std::greater<>>::value;
+
+            if ((ascending || descending) && size_ >= radixSortThreshold) {
+                auto identity = [](const T& x) { return x; };
+                radixSort(identity, descending);
+                return;
+            }
+        }
+
+        auto [first, last] = mergeSort(head, comp);
+        head = first;
+        tail = last;
+    }
+
+    // Stable LSD radix sort by an integral key extracted with
+    // `key(element)`; the list is relinked in ascending key order. Runs in
+    // O(n) per key byte, and key bytes that are equal across the whole list
+    // cost no pass, so narrow or skewed key ranges sort faster still.
+    template <typename KeyExtractor>
+    void radix_sort(KeyExtractor key) {
+        if (empty()) return;
+
+        radixSort(key, false);
+    }
+
+#if defined(FREELIST_PARALLEL_SORT) && defined(__cpp_lib_execution)
+    // Sorts the whole list under an execution policy such as
+    // std::execution::par: the nodes are sorted in a contiguous buffer on
+    // all cores and relinked in one pass. Lists shorter than
+    // parallelSortThreshold use the sequential merge sort instead. With
+    // `compactStorage` the nodes are also relaid out in sorted order, as by
+    // compact(), so later traversals stream through memory.
+    template <typename ExecutionPolicy, typename Compare = std::less<T>,
+              typename = std::enable_if_t<std::is_execution_policy<std::decay_t<ExecutionPolicy>>::value>>
+    void sort(ExecutionPolicy&& policy, const Compare& comp = Compare(), bool compactStorage = false) {
+        if (size_ < parallelSortThreshold) {
+            sort(comp);
+        } else {
+            sortGathered(std::forward<ExecutionPolicy>(policy), comp);
+        }
+
+        if (compactStorage) {
+            compact();
+        }
     }
+#endif
 
+    // Sorts the half-open range [start, _end) in place, leaving the nodes
+    // outside of it untouched. A default-constructed `start` or `_end`
+    // stands for begin() or end(), as in the original interface; `start`
+    // itself has no default, which would make sort() ambiguous.
     template <typename Compare = std::less<T> >
-    void sort(const const_iterator start = const_iterator(),
+    void sort(const const_iterator start,
 	      const const_iterator _end = const_iterator(),
 	      const Compare& comp = Compare())
     {
-        if (empty() || start == end() || start == _end) return;
+        Index start_idx = (start == const_iterator()) ? head : start.getIndex();
+        Index end_idx = _end.getIndex();
+
+        if (empty() || start_idx == end_idx) return;
 
-        iterator actualStart = (start == const_iterator()) ? cbegin() : start;
-        iterator actualEnd = (_end == const_iterator()) ? cend() : _end;
+        Index before = link(start_idx).prev;
+        Index last_idx = (end_idx == npos) ? tail : link(end_idx).prev;
 
-        size_t start_idx = actualStart.getIndex();
-        size_t end_idx = (actualEnd == cend()) ? tail : _end.getIndex();
+        // Detach the range so it forms a standalone chain
+        link(start_idx).prev = npos;
+        link(last_idx).next = npos;
 
-        head = mergeSort(start_idx, end_idx, comp);
+        auto [first, last] = mergeSort(start_idx, comp);
+
+        if (before == npos) {
+            head = first;
+        } else {
+            link(before).next = first;
+        }
+        link(first).prev = before;
+
+        if (end_idx == npos) {
+            tail = last;
+        } else {
+            link(end_idx).prev = last;
+        }
+        link(last).next = end_idx;
     }
 
     void reserve(size_t count) {
+        if (count > max_size()) {
+            throw std::length_error("FreeList: index type cannot address that many nodes");
+        }
         nodes.reserve(count);
     }
 
     template <typename U>
     void push_front(U&& data) {
-        size_t index = allocateNode(std::forward<U>(data));
-    
-        if (head != SIZE_MAX) {
-            nodes[index].next = head;
-            nodes[head].prev = index;
-        }
-
-        head = index;
-
-        if (tail == SIZE_MAX) {
-            tail = index;
-        }
+        linkBefore(head, allocateNode(head, std::forward<U>(data)));
     }
     
     template <typename U>
     void push_back(U&& data) {
-        size_t index = allocateNode(std::forward<U>(data));
-    
-        if (head == SIZE_MAX) {
-            head = index;
-            tail = index;
-        } else {
-            nodes[tail].next = index;
-            nodes[index].prev = tail;
-            tail = index;
-        }
+        linkBefore(npos, allocateNode(tail, std::forward<U>(data)));
     }
 
     template<class... Args>
     iterator emplace(const_iterator pos, Args&&... args) {
+        Index newIndex = allocateNode(neighbour(pos.getIndex()), std::forward<Args>(args)...);
+        linkBefore(pos.getIndex(), newIndex);
 
-        if (pos == end()) {
-            return insert(end(), T(std::forward<Args>(args)...));
-        }
-
-        size_t currentIndex = pos.getIndex();
-
-        size_t newIndex = allocateNode(T(std::forward<Args>(args)...));
-
-        nodes[newIndex].next = currentIndex;
-        nodes[newIndex].prev = nodes[currentIndex].prev;
-
-        if (nodes[currentIndex].prev != SIZE_MAX) {
-            nodes[nodes[currentIndex].prev].next = newIndex;
-        } else {
-            head = newIndex;
-        }
+        return iterator(this, newIndex);
+    }
 
-        nodes[currentIndex].prev = newIndex;
+    template<typename... Args>
+    T& emplace_front(Args&&... args) {
+        Index index = allocateNode(head, std::forward<Args>(args)...);
+        linkBefore(head, index);
 
-        return iterator(this, newIndex);
+        return value(index);
     }
 
     template<typename... Args>
     T& emplace_back(Args&&... args) {
-        size_t index = allocateNode(T(std::forward<Args>(args)...));
+        Index index = allocateNode(tail, std::forward<Args>(args)...);
+        linkBefore(npos, index);
 
-        if (head == SIZE_MAX) {
-            head = index;
-            tail = index;
-        } else {
-            nodes[tail].next = index;
-            nodes[index].prev = tail;
-            tail = index;
-        }
-
-        return nodes[index].data;
+        return value(index);
     }
 
     iterator erase(iterator pos) {
@@ -490,20 +1162,185 @@ public:
         return iterator(this, next.getIndex());
     }
 
+    // Unlinks the whole range with O(1) link updates and hands its slots
+    // to the slot policy in one batch.
+    iterator erase(const_iterator first, const_iterator last) {
+        if (first != last) {
+            Index firstIndex = first.getIndex();
+            Index lastIndex = (last.getIndex() == npos) ? tail : link(last.getIndex()).prev;
+
+            unlinkRange(firstIndex, lastIndex);
+            releaseRange(firstIndex, lastIndex);
+        }
+
+        return iterator(this, last.getIndex());
+    }
+
     iterator erase(iterator first, iterator last) {
-        while (first != last) {
-            first = erase(first);
+        return erase(const_iterator(first), const_iterator(last));
+    }
+
+    // Visits every element in list order. Nodes are gathered in groups of
+    // prefetchGroup and their payloads requested together before `f` runs on
+    // them, so the payload loads of a group overlap instead of following each
+    // link hop.
+    template <typename Function>
+    Function for_each(Function f) {
+        Index group[prefetchGroup];
+
+        for (Index curr = head; curr != npos;) {
+            size_t count = 0;
+
+            for (; count < prefetchGroup && curr != npos; ++count) {
+                group[count] = curr;
+                prefetch(curr);
+                curr = link(curr).next;
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                f(value(group[i]));
+            }
         }
 
-        return last;
+        return f;
     }
 
-    iterator erase(const_iterator first, const_iterator last) {
-        while (first != last) {
-            first = erase(first);
+    // Visits every element in list order while a lookahead cursor runs
+    // `distance` hops ahead (at most maxPrefetchDistance) and prefetches the
+    // payloads it passes. Larger distances hide more latency on fragmented
+    // lists at the cost of a few more wasted lines at the end.
+    template <typename Function>
+    Function for_each_prefetch(Function f, size_t distance = defaultPrefetchDistance) {
+        Index ring[maxPrefetchDistance];
+        distance = std::min(std::max<size_t>(distance, 1), maxPrefetchDistance);
+
+        size_t queued = 0;
+        Index ahead = head;
+
+        for (; queued < distance && ahead != npos; ++queued) {
+            ring[queued] = ahead;
+            prefetch(ahead);
+            ahead = link(ahead).next;
         }
 
-        return iterator(this, last.getIndex());
+        for (size_t slot = 0; queued > 0; slot = (slot + 1 == distance) ? 0 : slot + 1) {
+            Index curr = ring[slot];
+
+            if (ahead != npos) {
+                ring[slot] = ahead;
+                prefetch(ahead);
+                ahead = link(ahead).next;
+            } else {
+                queued--;
+            }
+
+            f(value(curr));
+        }
+
+        return f;
+    }
+
+    // Range of PrefetchIterators over the whole list, for range-for loops
+    PrefetchRange prefetched(size_t distance = defaultPrefetchDistance) {
+        return {PrefetchIterator(this, head, distance), PrefetchIterator(this, npos, 0)};
+    }
+
+    // Storage-order scans: every element is visited exactly once, but in
+    // slot order rather than list order, by walking the liveness bitmap
+    // instead of the links. Use them where order does not matter.
+    template <typename Function>
+    Function for_each_unordered(Function f) {
+        visitLive([&](Index index) { f(value(index)); });
+        return f;
+    }
+
+    template <typename Function>
+    Function for_each_unordered(Function f) const {
+        visitLive([&](Index index) { f(value(index)); });
+        return f;
+    }
+
+    // Some element equal to `target`, not necessarily the first in list
+    // order, or end().
+    iterator find_unordered(const T& target) {
+        return iterator(this, findLive([&](Index index) { return value(index) == target; }));
+    }
+
+    const_iterator find_unordered(const T& target) const {
+        return const_iterator(this, findLive([&](Index index) { return value(index) == target; }));
+    }
+
+    template <typename Predicate>
+    size_t count_if_unordered(Predicate pred) const {
+        size_t count = 0;
+        visitLive([&](Index index) { count += pred(value(index)) ? 1 : 0; });
+        return count;
+    }
+
+    // Smallest element; the list must not be empty. Arithmetic payloads are
+    // reduced by value so the dense loop vectorises.
+    T min() const {
+        if constexpr (std::is_arithmetic<T>::value) {
+            T result = value(head);
+            visitLive([&](Index index) { result = std::min(result, value(index)); });
+            return result;
+        } else {
+            Index best = head;
+            visitLive([&](Index index) { if (value(index) < value(best)) best = index; });
+            return value(best);
+        }
+    }
+
+    // Largest element; the list must not be empty.
+    T max() const {
+        if constexpr (std::is_arithmetic<T>::value) {
+            T result = value(head);
+            visitLive([&](Index index) { result = std::max(result, value(index)); });
+            return result;
+        } else {
+            Index best = head;
+            visitLive([&](Index index) { if (value(best) < value(index)) best = index; });
+            return value(best);
+        }
+    }
+
+    // Sum of all elements, starting from a value-initialised T
+    T sum() const {
+        T result = T();
+        visitLive([&](Index index) { result = result + value(index); });
+        return result;
+    }
+
+    Handle handle(const_iterator pos) const {
+        return {pos.getIndex(), generations[pos.getIndex()]};
+    }
+
+    // True while the element `h` was taken from is still in this list. A
+    // slot's generation only changes when its node is freed or moved, so
+    // one comparison settles it.
+    bool contains(Handle h) const {
+        return h.index < generations.size() && generations[h.index] == h.generation;
+    }
+
+    // The element behind `h`, or nullptr for a stale handle
+    T* get(Handle h) {
+        return contains(h) ? &value(h.index) : nullptr;
+    }
+
+    const T* get(Handle h) const {
+        return contains(h) ? &value(h.index) : nullptr;
+    }
+
+    iterator iterator_to(Handle h) {
+        return iterator(this, contains(h) ? h.index : npos);
+    }
+
+    // Erases the element behind `h`; returns false for a stale handle
+    bool erase(Handle h) {
+        if (!contains(h)) return false;
+
+        remove(h.index);
+        return true;
     }
 
     iterator find(const T& value) {
@@ -517,139 +1354,248 @@ public:
 
     template <typename U>
     iterator insert(const_iterator it, U&& data) {
-        size_t newIndex = allocateNode(std::forward<U>(data));
-    
-        if (!(it == end())) {
-            size_t currentIndex = it.getIndex();
-    
-            nodes[newIndex].next = currentIndex;
-            nodes[newIndex].prev = nodes[currentIndex].prev;
-    
-            if (nodes[currentIndex].prev != SIZE_MAX) {
-                nodes[nodes[currentIndex].prev].next = newIndex;
-            } else {
-                head = newIndex;
-            }
-    
-            nodes[currentIndex].prev = newIndex;
-        } else {
+        Index newIndex = allocateNode(neighbour(it.getIndex()), std::forward<U>(data));
+        linkBefore(it.getIndex(), newIndex);
 
-            if (tail != SIZE_MAX) {
-                nodes[tail].next = newIndex;
-                nodes[newIndex].prev = tail;
-            } else {
-                head = newIndex;
-            }
-            tail = newIndex;
-        }
-    
         return iterator(this, newIndex);
     }
 
     iterator insert(const_iterator it, const T& data) {
-        size_t newIndex = allocateNode(data);
-    
-        if (!(it == end())) {
-            size_t currentIndex = it.getIndex();
-    
-            nodes[newIndex].next = currentIndex;
-            nodes[newIndex].prev = nodes[currentIndex].prev;
-    
-            if (nodes[currentIndex].prev != SIZE_MAX) {
-                nodes[nodes[currentIndex].prev].next = newIndex;
-            } else {
-                head = newIndex;
-            }
-    
-            nodes[currentIndex].prev = newIndex;
-        } else {
+        Index newIndex = allocateNode(neighbour(it.getIndex()), data);
+        linkBefore(it.getIndex(), newIndex);
 
-            if (tail != SIZE_MAX) {
-                nodes[tail].next = newIndex;
-                nodes[newIndex].prev = tail;
-            } else {
-                head = newIndex;
-            }
-            tail = newIndex;
-        }
-    
         return iterator(this, newIndex);
     }
 
-    template<class InputIt>
+    // Forward ranges are sized up front and built as one chain that is
+    // spliced in once; single-pass ranges are linked element by element.
+    template<class InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
     iterator insert(const_iterator pos, InputIt first, InputIt last) {
-        size_t currentIndex = pos.getIndex();
-        size_t firstNewIndex = SIZE_MAX;
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+
+        if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value) {
+            size_t count = static_cast<size_t>(std::distance(first, last));
+            // The tuple holds `reference` itself, so iterators that yield
+            // prvalues (such as std::vector<bool>'s) do not leave it dangling
+            using Reference = typename std::iterator_traits<InputIt>::reference;
+            auto chain = allocateChain(count, neighbour(pos.getIndex()), [&first] { return std::tuple<Reference>(*first++); });
+            return iterator(this, spliceChain(pos.getIndex(), chain));
+        } else {
+            Index firstNewIndex = npos;
 
-        while (first != last) {
-            size_t newIndex = allocateNode(*first++);
+            while (first != last) {
+                Index newIndex = allocateNode(neighbour(pos.getIndex()), *first++);
+                linkBefore(pos.getIndex(), newIndex);
 
-            if (firstNewIndex == SIZE_MAX) {
-                firstNewIndex = newIndex;
+                if (firstNewIndex == npos) {
+                    firstNewIndex = newIndex;
+                }
             }
 
-            if (currentIndex != SIZE_MAX) {
-                nodes[newIndex].next = currentIndex;
-                nodes[newIndex].prev = nodes[currentIndex].prev;
+            return iterator(this, (firstNewIndex == npos) ? pos.getIndex() : firstNewIndex);
+        }
+    }
 
-                if (nodes[currentIndex].prev != SIZE_MAX) {
-                    nodes[nodes[currentIndex].prev].next = newIndex;
-                } else {
-                    head = newIndex;
-                }
+    iterator insert(const_iterator pos, size_t count, const T& data) {
+        auto chain = allocateChain(count, neighbour(pos.getIndex()), [&data] { return std::forward_as_tuple(data); });
+        return iterator(this, spliceChain(pos.getIndex(), chain));
+    }
 
-                nodes[currentIndex].prev = newIndex;
-                currentIndex = newIndex;
-            } else {
-                if (tail != SIZE_MAX) {
-                    nodes[tail].next = newIndex;
-                    nodes[newIndex].prev = tail;
-                } else {
-                    head = newIndex;
-                }
-                tail = newIndex;
+    // Links `count` value-initialised elements in front of `pos` as one
+    // pre-linked run and returns its first element, for producers that
+    // fill the payloads in place afterwards.
+    iterator allocate_n(const_iterator pos, size_t count) {
+        auto chain = allocateChain(count, neighbour(pos.getIndex()), [] { return std::tuple<>(); });
+        return iterator(this, spliceChain(pos.getIndex(), chain));
+    }
+
+    iterator insert(const_iterator pos, std::initializer_list<T> ilist) {
+        return insert(pos, ilist.begin(), ilist.end());
+    }
+
+    // Moves [first, last) of `other` in front of `pos`. Within one list this
+    // only relinks the range in O(1). Across lists the payloads are moved
+    // into slots of this list and the source slots are released together.
+    void splice(const_iterator pos, FreeList& other, const_iterator first, const_iterator last) {
+        if (first == last) return;
+
+        if (&other == this) {
+            Index firstIndex = first.getIndex();
+            Index lastIndex = (last.getIndex() == npos) ? tail : link(last.getIndex()).prev;
+
+            unlinkRange(firstIndex, lastIndex);
+            linkRangeBefore(pos.getIndex(), firstIndex, lastIndex);
+            return;
+        }
+
+        // The payloads move into one chain that is linked in once, and
+        // their old nodes are released as one run
+        size_t count = static_cast<size_t>(std::distance(first, last));
+        Index from = first.getIndex();
+        auto chain = allocateChain(count, neighbour(pos.getIndex()), [&other, &from] {
+            Index curr = from;
+            from = other.link(curr).next;
+            return std::forward_as_tuple(std::move(other.value(curr)));
+        });
+        spliceChain(pos.getIndex(), chain);
+
+        other.erase(first, last);
+    }
+
+    void splice(const_iterator pos, FreeList& other, const_iterator it) {
+        splice(pos, other, it, std::next(it));
+    }
+
+    void splice(const_iterator pos, FreeList& other) {
+        splice(pos, other, other.cbegin(), other.cend());
+    }
+
+    // Merges the sorted list `other` into this sorted list. Elements of this
+    // list come before equal elements of `other`; `other` ends up empty.
+    // The payloads of `other` move into one detached chain, which is merged
+    // with this list by relinking, as in the merge sort.
+    template <typename Compare = std::less<T> >
+    void merge(FreeList& other, const Compare& comp = Compare()) {
+        if (&other == this || other.empty()) return;
+
+        Index from = other.head;
+        auto chain = allocateChain(other.size_, tail, [&other, &from] {
+            Index curr = from;
+            from = other.link(curr).next;
+            return std::forward_as_tuple(std::move(other.value(curr)));
+        });
+
+        compactCursor = npos;
+        head = merge(head, chain.first, comp);
+
+        Index prev = npos;
+        for (Index curr = head; curr != npos; curr = link(curr).next) {
+            link(curr).prev = prev;
+            prev = curr;
+        }
+        tail = prev;
+
+        other.clear();
+    }
+
+    void reverse() noexcept {
+        compactCursor = npos;
+        for (Index curr = head; curr != npos; curr = link(curr).prev) {
+            std::swap(link(curr).next, link(curr).prev);
+        }
+
+        std::swap(head, tail);
+    }
+
+    // Makes `middle` the first element in O(1), like std::rotate over the
+    // whole list. Returns the new position of the previous first element.
+    iterator rotate(const_iterator middle) {
+        Index oldHead = head;
+
+        if (middle.getIndex() == npos || middle.getIndex() == head) {
+            return iterator(this, oldHead);
+        }
+
+        Index newTail = link(middle.getIndex()).prev;
+
+        unlinkRange(head, newTail);
+        linkRangeBefore(npos, oldHead, newTail);
+
+        return iterator(this, oldHead);
+    }
+
+    // Single pass; every run of consecutive matches is unlinked and freed as
+    // one batch.
+    template <typename Predicate>
+    size_t remove_if(Predicate pred) {
+        size_t removed = 0;
+
+        for (Index curr = head; curr != npos;) {
+            if (!pred(value(curr))) {
+                curr = link(curr).next;
+                continue;
+            }
+
+            Index runLast = curr;
+            Index next = link(curr).next;
+
+            while (next != npos && pred(value(next))) {
+                runLast = next;
+                next = link(next).next;
             }
+
+            unlinkRange(curr, runLast);
+            removed += releaseRange(curr, runLast);
+            curr = next;
         }
 
-        return iterator(this, firstNewIndex);
+        return removed;
     }
 
-    iterator insert(const_iterator pos, std::initializer_list<T> ilist) {
-        return insert(pos, ilist.begin(), ilist.end());
+    // Removes all but the first element of every run of equal elements.
+    // Each run of duplicates is unlinked and freed as one batch.
+    template <typename BinaryPredicate = std::equal_to<T> >
+    size_t unique(BinaryPredicate pred = BinaryPredicate()) {
+        size_t removed = 0;
+
+        for (Index prev = head; prev != npos;) {
+            Index runLast = npos;
+            Index next = link(prev).next;
+
+            while (next != npos && pred(value(prev), value(next))) {
+                runLast = next;
+                next = link(next).next;
+            }
+
+            if (runLast != npos) {
+                Index runFirst = link(prev).next;
+                unlinkRange(runFirst, runLast);
+                removed += releaseRange(runFirst, runLast);
+            }
+
+            prev = next;
+        }
+
+        return removed;
     }
 
-    void swap(FreeList& other) noexcept {
+    // noexcept unless the storage's swap can throw, as SmallStorage's does
+    // for payloads with throwing moves
+    void swap(FreeList& other) noexcept(noexcept(std::declval<Storage&>().swap(std::declval<Storage&>()))) {
+        nodes.swap(other.nodes);
         std::swap(head, other.head);
         std::swap(tail, other.tail);
-        std::swap(freeHead, other.freeHead);
-        nodes.swap(other.nodes);
+        slots.swap(other.slots);
         std::swap(size_, other.size_);
+        live.swap(other.live);
+        generations.swap(other.generations);
+        std::swap(compactCursor, other.compactCursor);
     }
 
     const T& front() const {
-        return nodes[head].data;
+        return value(head);
     }
 
     const T& back() const {
-        return nodes[tail].data;
+        return value(tail);
     }
 
     T& front() {
-        return nodes[head].data;
+        return value(head);
     }
 
     T& back() {
-        return nodes[tail].data;
+        return value(tail);
     }
 
     void pop_front() {
-        if (head == SIZE_MAX) return;
+        if (head == npos) return;
     
         remove(head);
     }
 
     void pop_back() {
-        if (tail == SIZE_MAX) { 
+        if (tail == npos) { 
             return;
         }
     
@@ -657,13 +1603,17 @@ public:
     }
 
     bool empty() const noexcept {
-        return head == SIZE_MAX && tail == SIZE_MAX;
+        return head == npos && tail == npos;
     }
 
     size_t size() const noexcept {
         return size_;
     }
 
+    size_t max_size() const noexcept {
+        return std::min<size_t>(npos, nodes.max_size());
+    }
+
     size_t capacity() const noexcept {
         return nodes.capacity();
     }
@@ -672,11 +1622,122 @@ public:
         nodes.shrink_to_fit();
     }
 
+    // Relays the nodes out in list order: the i-th element ends up in slot
+    // i, free slots are dropped and capacity() shrinks to size().
+    // `remap(from, to)` is invoked once per element after the move, where
+    // `from` compares equal to iterators taken before the call and `to`
+    // is the element's new position. Every element is reported, since all
+    // of them are relocated to new storage.
+    template <typename Remap>
+    void compact(Remap&& remap) {
+        Storage compacted(get_allocator());
+        compacted.reserve(size_);
+
+        Index oldHead = head;
+
+        for (Index curr = head; curr != npos; curr = link(curr).next) {
+            Index index = compacted.emplace_back(std::move(value(curr)));
+            compacted.link(index).next = index + 1;
+            compacted.link(index).prev = (index == 0) ? npos : index - 1;
+        }
+
+        if (size_ != 0) {
+            compacted.link(static_cast<Index>(size_ - 1)).next = npos;
+        }
+
+        Bitmap packed((size_ + bitsPerWord - 1) / bitsPerWord, fullWord, live.get_allocator());
+        if (size_ % bitsPerWord != 0) {
+            packed.back() = (uint64_t(1) << (size_ % bitsPerWord)) - 1;
+        }
+
+        // Every node may have moved, so all slots move past every generation
+        // any Handle can still carry
+        Generation generation = generations.empty() ? 0 : *std::max_element(generations.begin(), generations.end());
+        std::fill(generations.begin(), generations.end(), static_cast<Generation>(generation + 1));
+
+        nodes.swap(compacted);
+        live.swap(packed);
+        head = (size_ == 0) ? npos : 0;
+        tail = (size_ == 0) ? npos : static_cast<Index>(size_ - 1);
+        slots.clear();
+        compactCursor = npos;
+
+        Index index = 0;
+        for (Index curr = oldHead; curr != npos; curr = compacted.link(curr).next) {
+            remap(const_iterator(this, curr), iterator(this, index++));
+        }
+    }
+
+    void compact() {
+        compact([](const_iterator, iterator) {});
+    }
+
+    // Incremental form of compact(): performs at most `maxSteps` units of
+    // work, each placing the next element in list order into the next
+    // occupied slot in storage order. Free slots are left where they are
+    // and capacity() is unchanged. Progress is kept between calls while the
+    // list is left alone; any insertion, erase or relink in between
+    // restarts the pass. `remap(from, to)` is invoked for both elements of
+    // every swap. Returns true once the whole list has been laid out.
+    template <typename Remap>
+    bool compact_step(size_t maxSteps, Remap&& remap) {
+        for (size_t step = 0; step < maxSteps; ++step) {
+            Index curr = (compactCursor == npos) ? head : link(compactCursor).next;
+            Index slot = (compactCursor == npos) ? 0 : compactCursor + 1;
+
+            while (slot < nodes.size() && isFree(slot)) {
+                slot++;
+            }
+
+            if (curr == npos || slot >= nodes.size()) {
+                compactCursor = npos;
+                return true;
+            }
+
+            if (curr != slot) {
+                swapSlots(curr, slot);
+                remap(const_iterator(this, curr), iterator(this, slot));
+                remap(const_iterator(this, slot), iterator(this, curr));
+            }
+
+            compactCursor = slot;
+        }
+
+        return false;
+    }
+
+    bool compact_step(size_t maxSteps) {
+        return compact_step(maxSteps, [](const_iterator, iterator) {});
+    }
+
     void clear() {
-        head = tail = freeHead = SIZE_MAX;
+        compactCursor = npos;
+        head = tail = npos;
+        slots.clear();
+        visitLive([this](Index index) { generations[index]++; });
         size_ = 0;
         nodes.clear();
+        live.clear();
     }
 };
 
+template<typename T, typename Index, typename StoragePolicy, typename SlotPolicy, typename Allocator,
+         typename Predicate>
+size_t erase_if(FreeList<T, Index, StoragePolicy, SlotPolicy, Allocator>& list, Predicate pred) {
+    return list.remove_if(pred);
+}
+
+// FreeList whose first N nodes are stored inside the list object; it only
+// allocates once it grows past them. See SmallStorage.
+template<typename T, size_t N, typename Index = size_t, typename SlotPolicy = LifoSlots,
+         typename Allocator = std::allocator<T>>
+using SmallFreeList = FreeList<T, Index, SmallStorage<N>, SlotPolicy, Allocator>;
+
+// FreeList drawing its memory from a std::pmr::memory_resource, such as a
+// monotonic arena. Nested PmrFreeLists in the payloads pick up the same
+// resource through uses-allocator construction.
+template<typename T, typename Index = size_t, typename StoragePolicy = InterleavedStorage,
+         typename SlotPolicy = LifoSlots>
+using PmrFreeList = FreeList<T, Index, StoragePolicy, SlotPolicy, std::pmr::polymorphic_allocator<T>>;
+
 #endif
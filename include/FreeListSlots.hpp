@@ -0,0 +1,284 @@
+#ifndef FREELIST_SLOTS_HPP
+#define FREELIST_SLOTS_HPP
+
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <memory>
+
+// Bitmap of free slot indices with find-first-set lookups, shared by the
+// bitmap-based slot policies below. Its words come from the list's
+// allocator.
+template<typename Index, typename Allocator = std::allocator<Index>>
+class FreeSlotBitmap {
+    using Words = std::vector<uint64_t,
+                              typename std::allocator_traits<Allocator>::template rebind_alloc<uint64_t>>;
+
+public:
+    static constexpr Index npos = std::numeric_limits<Index>::max();
+
+    explicit FreeSlotBitmap(const Allocator& alloc = Allocator())
+        : words(typename Words::allocator_type(alloc)), count(0), lowest(0) {}
+
+    FreeSlotBitmap(const FreeSlotBitmap& other) = default;
+    FreeSlotBitmap(FreeSlotBitmap&& other) noexcept = default;
+    FreeSlotBitmap& operator=(const FreeSlotBitmap& other) = default;
+    FreeSlotBitmap& operator=(FreeSlotBitmap&& other) = default;
+
+    FreeSlotBitmap(const FreeSlotBitmap& other, const Allocator& alloc)
+        : words(other.words, typename Words::allocator_type(alloc)), count(other.count), lowest(other.lowest) {}
+
+    FreeSlotBitmap(FreeSlotBitmap&& other, const Allocator& alloc)
+        : words(std::move(other.words), typename Words::allocator_type(alloc)),
+          count(other.count), lowest(other.lowest) {}
+
+    bool empty() const noexcept {
+        return count == 0;
+    }
+
+    // Makes room for indices below `count`, so that set() never allocates
+    void reserve(size_t count) {
+        size_t needed = (count + bitsPerWord - 1) / bitsPerWord;
+
+        if (needed > words.size()) {
+            words.resize(std::max(needed, words.size() * 2), 0);
+        }
+    }
+
+    // `index` must be covered by an earlier reserve()
+    void set(Index index) noexcept {
+        size_t word = index / bitsPerWord;
+
+        words[word] |= bit(index);
+        count++;
+
+        if (word < lowest) {
+            lowest = word;
+        }
+    }
+
+    void reset(Index index) {
+        words[index / bitsPerWord] &= ~bit(index);
+        count--;
+    }
+
+    // Lowest free index; the bitmap must not be empty. Words below `lowest`
+    // are known to be zero, so repeated lookups resume where the last one
+    // stopped.
+    Index first() {
+        while (words[lowest] == 0) {
+            lowest++;
+        }
+
+        return static_cast<Index>(lowest * bitsPerWord + lowestBit(words[lowest]));
+    }
+
+    // Free index closest to `hint`, searching at most `searchWords` words
+    // either side before falling back to first(). The bitmap must not be
+    // empty.
+    Index nearest(Index hint) {
+        size_t word = hint / bitsPerWord;
+
+        if (hint == npos || word >= words.size()) {
+            return first();
+        }
+
+        unsigned offset = hint % bitsPerWord;
+        uint64_t above = words[word] & (~uint64_t(0) << offset);
+        uint64_t below = words[word] & ((uint64_t(1) << offset) - 1);
+
+        for (size_t distance = 0; distance <= searchWords; ++distance) {
+            if (distance > 0) {
+                above = (word + distance < words.size()) ? words[word + distance] : 0;
+                below = (word >= distance) ? words[word - distance] : 0;
+            }
+
+            if (above == 0 && below == 0) continue;
+
+            size_t up = (word + distance) * bitsPerWord + (above ? lowestBit(above) : 0);
+            size_t down = (word - distance) * bitsPerWord + (below ? highestBit(below) : 0);
+
+            if (below == 0 || (above != 0 && up - hint < hint - down)) {
+                return static_cast<Index>(up);
+            }
+            return static_cast<Index>(down);
+        }
+
+        return first();
+    }
+
+    // Keeps the words, so the slots reserved so far stay covered
+    void clear() noexcept {
+        std::fill(words.begin(), words.end(), 0);
+        count = 0;
+        lowest = 0;
+    }
+
+    void swap(FreeSlotBitmap& other) noexcept {
+        words.swap(other.words);
+        std::swap(count, other.count);
+        std::swap(lowest, other.lowest);
+    }
+
+private:
+    static constexpr size_t bitsPerWord = 64;
+    static constexpr size_t searchWords = 16;
+
+    static uint64_t bit(Index index) {
+        return uint64_t(1) << (index % bitsPerWord);
+    }
+
+    static unsigned lowestBit(uint64_t word) {
+        return static_cast<unsigned>(__builtin_ctzll(word));
+    }
+
+    static unsigned highestBit(uint64_t word) {
+        return static_cast<unsigned>(bitsPerWord - 1 - __builtin_clzll(word));
+    }
+
+    Words words;
+    size_t count;
+    size_t lowest;
+};
+
+// Slot policies decide which free slot a new node lands in. Each exposes a
+// nested `type<Index, Allocator>` with the same interface: pick(nodes,
+// hint) names the slot to use next, acquire(nodes, index) takes it off the
+// free set once the payload is constructed, and release/releaseRun hand
+// freed slots back. `hint` is the slot of the new node's list neighbour, or
+// npos. reserve(nodes, count) is called before storage grows to `count`
+// slots and does any allocating, so that freeing a node never throws.
+
+// Freed slots are reused most recent first through a free chain threaded
+// through the slots' next links. O(1) everywhere and no extra memory.
+struct LifoSlots {
+    template<typename Index, typename Allocator = std::allocator<Index>>
+    class type {
+    public:
+        static constexpr Index npos = std::numeric_limits<Index>::max();
+
+        type() = default;
+        explicit type(const Allocator&) {}
+        type(const type& other, const Allocator&) : freeHead(other.freeHead) {}
+
+        bool empty() const noexcept { return freeHead == npos; }
+
+        template <typename Storage>
+        void reserve(Storage&, size_t) {}
+
+        template <typename Storage>
+        Index pick(Storage&, Index) const { return freeHead; }
+
+        template <typename Storage>
+        void acquire(Storage& nodes, Index index) {
+            freeHead = nodes.link(index).next;
+        }
+
+        template <typename Storage>
+        void release(Storage& nodes, Index index) {
+            nodes.link(index).next = freeHead;
+            freeHead = index;
+        }
+
+        // The run's next links already form a chain, so it is attached whole
+        template <typename Storage>
+        void releaseRun(Storage& nodes, Index first, Index last) {
+            nodes.link(last).next = freeHead;
+            freeHead = first;
+        }
+
+        void clear() noexcept { freeHead = npos; }
+
+        void swap(type& other) noexcept { std::swap(freeHead, other.freeHead); }
+
+    private:
+        Index freeHead = npos;
+    };
+};
+
+// Always reuses the lowest free index, so live nodes pack towards the front
+// of storage and iteration stays mostly forward in memory.
+struct LowestFirstSlots {
+    template<typename Index, typename Allocator = std::allocator<Index>>
+    class type {
+    public:
+        type() = default;
+        explicit type(const Allocator& alloc) : freeSlots(alloc) {}
+        type(const type& other, const Allocator& alloc) : freeSlots(other.freeSlots, alloc) {}
+        type(type&& other, const Allocator& alloc) : freeSlots(std::move(other.freeSlots), alloc) {}
+        bool empty() const noexcept { return freeSlots.empty(); }
+
+        template <typename Storage>
+        Index pick(Storage&, Index) { return freeSlots.first(); }
+
+        template <typename Storage>
+        void acquire(Storage&, Index index) { freeSlots.reset(index); }
+
+        template <typename Storage>
+        void reserve(Storage&, size_t count) { freeSlots.reserve(count); }
+
+        template <typename Storage>
+        void release(Storage&, Index index) { freeSlots.set(index); }
+
+        template <typename Storage>
+        void releaseRun(Storage& nodes, Index first, Index last) {
+            for (Index curr = first;; curr = nodes.link(curr).next) {
+                freeSlots.set(curr);
+                if (curr == last) break;
+            }
+        }
+
+        void clear() noexcept { freeSlots.clear(); }
+
+        void swap(type& other) noexcept { freeSlots.swap(other.freeSlots); }
+
+    private:
+        FreeSlotBitmap<Index, Allocator> freeSlots;
+    };
+};
+
+// Reuses the free slot physically closest to the new node's list
+// neighbour, so insertions keep neighbours close in memory.
+struct NearestSlots {
+    template<typename Index, typename Allocator = std::allocator<Index>>
+    class type {
+    public:
+        type() = default;
+        explicit type(const Allocator& alloc) : freeSlots(alloc) {}
+        type(const type& other, const Allocator& alloc) : freeSlots(other.freeSlots, alloc) {}
+        type(type&& other, const Allocator& alloc) : freeSlots(std::move(other.freeSlots), alloc) {}
+        bool empty() const noexcept { return freeSlots.empty(); }
+
+        template <typename Storage>
+        Index pick(Storage&, Index hint) { return freeSlots.nearest(hint); }
+
+        template <typename Storage>
+        void acquire(Storage&, Index index) { freeSlots.reset(index); }
+
+        template <typename Storage>
+        void reserve(Storage&, size_t count) { freeSlots.reserve(count); }
+
+        template <typename Storage>
+        void release(Storage&, Index index) { freeSlots.set(index); }
+
+        template <typename Storage>
+        void releaseRun(Storage& nodes, Index first, Index last) {
+            for (Index curr = first;; curr = nodes.link(curr).next) {
+                freeSlots.set(curr);
+                if (curr == last) break;
+            }
+        }
+
+        void clear() noexcept { freeSlots.clear(); }
+
+        void swap(type& other) noexcept { freeSlots.swap(other.freeSlots); }
+
+    private:
+        FreeSlotBitmap<Index, Allocator> freeSlots;
+    };
+};
+
+#endif
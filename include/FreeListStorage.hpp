@@ -0,0 +1,1112 @@
+#ifndef FREELIST_STORAGE_HPP
+#define FREELIST_STORAGE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+// Links of a single FreeList slot. While a slot is live, next/prev link it
+// into the list. Once freed, prev is tagged with the slot's own index (a
+// live slot can never be its own predecessor) and next is left to the slot
+// policy, which LifoSlots uses as the link in its free chain.
+template<typename Index>
+struct FreeListLink {
+    static constexpr Index npos = std::numeric_limits<Index>::max();
+
+    Index next;
+    Index prev;
+
+    FreeListLink() : next(npos), prev(npos) {}
+
+    bool isFree(Index self) const {
+        return prev == self;
+    }
+};
+
+// Uninitialised storage for one payload. The owning storage decides when a
+// value is alive, based on the slot's links. Payloads are built and torn
+// down through the list's allocator, so allocators that perform
+// uses-allocator construction, such as std::pmr::polymorphic_allocator,
+// hand themselves on to allocator-aware payloads like nested lists.
+template<typename T>
+struct FreeListSlot {
+    alignas(T) unsigned char bytes[sizeof(T)];
+
+    FreeListSlot() {}
+
+    T& get() { return *std::launder(reinterpret_cast<T*>(bytes)); }
+    const T& get() const { return *std::launder(reinterpret_cast<const T*>(bytes)); }
+
+    template <typename Allocator, typename... Args>
+    void construct(Allocator& alloc, Args&&... args) {
+        std::allocator_traits<Allocator>::construct(alloc, reinterpret_cast<T*>(bytes), std::forward<Args>(args)...);
+    }
+
+    template <typename Allocator>
+    void destroy(Allocator& alloc) {
+        std::allocator_traits<Allocator>::destroy(alloc, &get());
+    }
+};
+
+// Storage policies decide how FreeList lays out its slots. Each exposes a
+// nested `type<T, Index, Allocator>` with the same interface: link(i) and
+// value(i) accessors, emplace_back/construct/destroy for payload lifetimes,
+// and vector-like growth of the slot array. Payloads are only alive in live
+// slots; free slots hold raw memory. Every allocation goes through
+// `Allocator`, rebound as needed, and copy, move and swap propagate it the
+// way the standard containers do. Swapping storages whose allocators
+// neither compare equal nor propagate is undefined, as for std::vector.
+
+// Keeps each payload next to its links in a single array of nodes. A
+// traversal step loads the whole node, which suits small payloads.
+struct InterleavedStorage {
+    template<typename T, typename Index, typename Allocator = std::allocator<T>>
+    class type {
+        struct Node {
+            FreeListSlot<T> data;
+            FreeListLink<Index> link;
+
+            Node() : link() {}
+        };
+
+        using AllocTraits = std::allocator_traits<Allocator>;
+        using Nodes = std::vector<Node, typename AllocTraits::template rebind_alloc<Node>>;
+
+    public:
+        using Link = FreeListLink<Index>;
+
+        type() : type(Allocator()) {}
+
+        explicit type(const Allocator& alloc) : nodes(typename Nodes::allocator_type(alloc)) {}
+
+        type(const type& other)
+            : type(other, AllocTraits::select_on_container_copy_construction(other.get_allocator())) {}
+
+        type(const type& other, const Allocator& alloc) : type(alloc) {
+            assignSlots(other);
+        }
+
+        type(type&& other) noexcept : nodes(std::move(other.nodes)) {}
+
+        type(type&& other, const Allocator& alloc) : type(alloc) {
+            if (get_allocator() == other.get_allocator()) {
+                nodes.swap(other.nodes);
+            } else {
+                assignSlots(std::move(other));
+                other.clear();
+            }
+        }
+
+        type& operator=(const type& other) {
+            if (this != &other) {
+                type copy(other, AllocTraits::propagate_on_container_copy_assignment::value
+                                     ? other.get_allocator() : get_allocator());
+                swap(copy);
+            }
+            return *this;
+        }
+
+        type& operator=(type&& other) noexcept(AllocTraits::propagate_on_container_move_assignment::value ||
+                                               AllocTraits::is_always_equal::value) {
+            clear();
+
+            if (AllocTraits::propagate_on_container_move_assignment::value ||
+                get_allocator() == other.get_allocator()) {
+                nodes = std::move(other.nodes);
+            } else {
+                assignSlots(std::move(other));
+                other.clear();
+            }
+            return *this;
+        }
+
+        ~type() {
+            clear();
+        }
+
+        Allocator get_allocator() const { return Allocator(nodes.get_allocator()); }
+
+        Link& link(Index index) { return nodes[index].link; }
+        const Link& link(Index index) const { return nodes[index].link; }
+
+        T& value(Index index) { return nodes[index].data.get(); }
+        const T& value(Index index) const { return nodes[index].data.get(); }
+
+        template <typename... Args>
+        Index emplace_back(Args&&... args) {
+            Index index = static_cast<Index>(nodes.size());
+            Allocator alloc = get_allocator();
+
+            if (nodes.size() == nodes.capacity()) {
+                // Construct before relocating, `args` may refer to an element
+                Nodes grown(nodes.get_allocator());
+                grown.reserve(std::max<size_t>(1, nodes.capacity() * 2));
+                grown.resize(nodes.size() + 1);
+                grown[index].data.construct(alloc, std::forward<Args>(args)...);
+                moveInto(grown);
+                return index;
+            }
+
+            nodes.emplace_back();
+
+            try {
+                nodes[index].data.construct(alloc, std::forward<Args>(args)...);
+            } catch (...) {
+                nodes.pop_back();
+                throw;
+            }
+
+            return index;
+        }
+
+        template <typename... Args>
+        void construct(Index index, Args&&... args) {
+            Allocator alloc = get_allocator();
+            nodes[index].data.construct(alloc, std::forward<Args>(args)...);
+        }
+
+        void destroy(Index index) {
+            Allocator alloc = get_allocator();
+            nodes[index].data.destroy(alloc);
+        }
+
+        void swap_slots(Index a, Index b) {
+            using std::swap;
+            swap(nodes[a].data.get(), nodes[b].data.get());
+            swap(nodes[a].link, nodes[b].link);
+        }
+
+        void swap(type& other) noexcept { nodes.swap(other.nodes); }
+
+        size_t size() const noexcept { return nodes.size(); }
+        size_t capacity() const noexcept { return nodes.capacity(); }
+        size_t max_size() const noexcept { return nodes.max_size(); }
+
+        void reserve(size_t count) {
+            if (count > nodes.capacity()) {
+                relocate(count);
+            }
+        }
+
+        void shrink_to_fit() {
+            if (nodes.size() < nodes.capacity()) {
+                relocate(nodes.size());
+            }
+        }
+
+        void clear() {
+            Allocator alloc = get_allocator();
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if (isLive(i)) {
+                    nodes[i].data.destroy(alloc);
+                }
+            }
+            nodes.clear();
+        }
+
+    private:
+        bool isLive(size_t index) const {
+            return !nodes[index].link.isFree(static_cast<Index>(index));
+        }
+
+        // Fills this empty storage slot by slot from `other`, copying the
+        // live payloads from an lvalue and moving them from an rvalue.
+        template <typename Other>
+        void assignSlots(Other&& other) {
+            Allocator alloc = get_allocator();
+            nodes.reserve(other.nodes.size());
+
+            try {
+                for (size_t i = 0; i < other.nodes.size(); ++i) {
+                    nodes.emplace_back();
+                    if (other.isLive(i)) {
+                        if constexpr (std::is_lvalue_reference<Other>::value) {
+                            nodes[i].data.construct(alloc, other.nodes[i].data.get());
+                        } else {
+                            nodes[i].data.construct(alloc, std::move(other.nodes[i].data.get()));
+                        }
+                    }
+                    nodes[i].link = other.nodes[i].link;
+                }
+            } catch (...) {
+                nodes.pop_back();
+                clear();
+                throw;
+            }
+        }
+
+        // Nodes are raw memory to std::vector, so growth moves the live
+        // payloads by hand instead of letting the vector copy bytes.
+        void moveInto(Nodes& grown) {
+            Allocator alloc = get_allocator();
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if (isLive(i)) {
+                    grown[i].data.construct(alloc, std::move(nodes[i].data.get()));
+                    nodes[i].data.destroy(alloc);
+                }
+                grown[i].link = nodes[i].link;
+            }
+
+            nodes.swap(grown);
+        }
+
+        void relocate(size_t count) {
+            Nodes grown(nodes.get_allocator());
+            grown.reserve(count);
+            grown.resize(nodes.size());
+            moveInto(grown);
+        }
+
+        Nodes nodes;
+    };
+};
+
+// Hot/cold split: links live in one dense array and payloads in a parallel
+// one. Link-only passes (traversal, sort relinking, splicing) touch only
+// the link array, which pays off once payloads are larger than a few words.
+struct SplitStorage {
+    template<typename T, typename Index, typename Allocator = std::allocator<T>>
+    class type {
+        using AllocTraits = std::allocator_traits<Allocator>;
+        using Links = std::vector<FreeListLink<Index>,
+                                  typename AllocTraits::template rebind_alloc<FreeListLink<Index>>>;
+        using Values = std::vector<FreeListSlot<T>,
+                                   typename AllocTraits::template rebind_alloc<FreeListSlot<T>>>;
+
+    public:
+        using Link = FreeListLink<Index>;
+
+        type() : type(Allocator()) {}
+
+        explicit type(const Allocator& alloc)
+            : links(typename Links::allocator_type(alloc)), values(typename Values::allocator_type(alloc)) {}
+
+        type(const type& other)
+            : type(other, AllocTraits::select_on_container_copy_construction(other.get_allocator())) {}
+
+        type(const type& other, const Allocator& alloc) : type(alloc) {
+            assignSlots(other);
+        }
+
+        type(type&& other) noexcept
+            : links(std::move(other.links)), values(std::move(other.values)) {}
+
+        type(type&& other, const Allocator& alloc) : type(alloc) {
+            if (get_allocator() == other.get_allocator()) {
+                swap(other);
+            } else {
+                assignSlots(std::move(other));
+                other.clear();
+            }
+        }
+
+        type& operator=(const type& other) {
+            if (this != &other) {
+                type copy(other, AllocTraits::propagate_on_container_copy_assignment::value
+                                     ? other.get_allocator() : get_allocator());
+                swap(copy);
+            }
+            return *this;
+        }
+
+        type& operator=(type&& other) noexcept(AllocTraits::propagate_on_container_move_assignment::value ||
+                                               AllocTraits::is_always_equal::value) {
+            clear();
+
+            if (AllocTraits::propagate_on_container_move_assignment::value ||
+                get_allocator() == other.get_allocator()) {
+                links = std::move(other.links);
+                values = std::move(other.values);
+            } else {
+                assignSlots(std::move(other));
+                other.clear();
+            }
+            return *this;
+        }
+
+        ~type() {
+            clear();
+        }
+
+        Allocator get_allocator() const { return Allocator(values.get_allocator()); }
+
+        Link& link(Index index) { return links[index]; }
+        const Link& link(Index index) const { return links[index]; }
+
+        T& value(Index index) { return values[index].get(); }
+        const T& value(Index index) const { return values[index].get(); }
+
+        template <typename... Args>
+        Index emplace_back(Args&&... args) {
+            Index index = static_cast<Index>(values.size());
+            Allocator alloc = get_allocator();
+
+            if (values.size() == values.capacity()) {
+                // Construct before relocating, `args` may refer to an element
+                size_t count = std::max<size_t>(1, values.capacity() * 2);
+                Values grown(values.get_allocator());
+                grown.reserve(count);
+                grown.resize(values.size() + 1);
+                grown[index].construct(alloc, std::forward<Args>(args)...);
+                links.reserve(count);
+                moveInto(grown);
+            } else {
+                values.emplace_back();
+
+                try {
+                    values[index].construct(alloc, std::forward<Args>(args)...);
+                } catch (...) {
+                    values.pop_back();
+                    throw;
+                }
+            }
+
+            links.emplace_back();
+            return index;
+        }
+
+        template <typename... Args>
+        void construct(Index index, Args&&... args) {
+            Allocator alloc = get_allocator();
+            values[index].construct(alloc, std::forward<Args>(args)...);
+        }
+
+        void destroy(Index index) {
+            Allocator alloc = get_allocator();
+            values[index].destroy(alloc);
+        }
+
+        void swap_slots(Index a, Index b) {
+            using std::swap;
+            swap(links[a], links[b]);
+            swap(values[a].get(), values[b].get());
+        }
+
+        void swap(type& other) noexcept {
+            links.swap(other.links);
+            values.swap(other.values);
+        }
+
+        size_t size() const noexcept { return links.size(); }
+        size_t capacity() const noexcept { return values.capacity(); }
+        size_t max_size() const noexcept { return std::min(links.max_size(), values.max_size()); }
+
+        void reserve(size_t count) {
+            if (count > values.capacity()) {
+                relocate(count);
+            }
+        }
+
+        void shrink_to_fit() {
+            links.shrink_to_fit();
+            if (values.size() < values.capacity()) {
+                relocate(values.size());
+            }
+        }
+
+        void clear() {
+            Allocator alloc = get_allocator();
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (isLive(i)) {
+                    values[i].destroy(alloc);
+                }
+            }
+            links.clear();
+            values.clear();
+        }
+
+    private:
+        bool isLive(size_t index) const {
+            return !links[index].isFree(static_cast<Index>(index));
+        }
+
+        // See InterleavedStorage::assignSlots
+        template <typename Other>
+        void assignSlots(Other&& other) {
+            Allocator alloc = get_allocator();
+            links = other.links;
+            values.reserve(other.values.size());
+
+            try {
+                for (size_t i = 0; i < other.values.size(); ++i) {
+                    values.emplace_back();
+                    if (isLive(i)) {
+                        if constexpr (std::is_lvalue_reference<Other>::value) {
+                            values[i].construct(alloc, other.values[i].get());
+                        } else {
+                            values[i].construct(alloc, std::move(other.values[i].get()));
+                        }
+                    }
+                }
+            } catch (...) {
+                values.pop_back();
+                clear();
+                throw;
+            }
+        }
+
+        // See InterleavedStorage::moveInto; only the payload array needs
+        // the manual move, links are plain data.
+        void moveInto(Values& grown) {
+            Allocator alloc = get_allocator();
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (isLive(i)) {
+                    grown[i].construct(alloc, std::move(values[i].get()));
+                    values[i].destroy(alloc);
+                }
+            }
+
+            values.swap(grown);
+        }
+
+        void relocate(size_t count) {
+            Values grown(values.get_allocator());
+            grown.reserve(count);
+            grown.resize(values.size());
+            links.reserve(count);
+            moveInto(grown);
+        }
+
+        Links links;
+        Values values;
+    };
+};
+
+// Segmented storage: slots live in fixed-size chunks of 2^ChunkBits nodes,
+// addressed by the high (chunk) and low (offset) bits of the index. Growth
+// allocates one new chunk and never moves existing nodes, so references to
+// elements stay valid while they are in the list and memory never doubles
+// up during a reallocation.
+template<unsigned ChunkBits = 12>
+struct ChunkedStorage {
+    static_assert(ChunkBits > 0 && ChunkBits < 32, "ChunkedStorage chunk size out of range");
+
+    template<typename T, typename Index, typename Allocator = std::allocator<T>>
+    class type {
+        struct Node {
+            FreeListSlot<T> data;
+            FreeListLink<Index> link;
+
+            Node() : link() {}
+        };
+
+        using AllocTraits = std::allocator_traits<Allocator>;
+        using NodeAllocator = typename AllocTraits::template rebind_alloc<Node>;
+        using NodeTraits = std::allocator_traits<NodeAllocator>;
+        using Chunks = std::vector<Node*, typename AllocTraits::template rebind_alloc<Node*>>;
+
+    public:
+        using Link = FreeListLink<Index>;
+
+        type() : type(Allocator()) {}
+
+        explicit type(const Allocator& alloc) : chunks(typename Chunks::allocator_type(alloc)), count(0) {}
+
+        type(const type& other)
+            : type(other, AllocTraits::select_on_container_copy_construction(other.get_allocator())) {}
+
+        type(const type& other, const Allocator& alloc) : type(alloc) {
+            assignSlots(other);
+        }
+
+        type(type&& other) noexcept : chunks(std::move(other.chunks)), count(other.count) {
+            other.count = 0;
+        }
+
+        type(type&& other, const Allocator& alloc) : type(alloc) {
+            if (get_allocator() == other.get_allocator()) {
+                swap(other);
+            } else {
+                assignSlots(std::move(other));
+                other.clear();
+            }
+        }
+
+        type& operator=(const type& other) {
+            if (this != &other) {
+                type copy(other, AllocTraits::propagate_on_container_copy_assignment::value
+                                     ? other.get_allocator() : get_allocator());
+                swap(copy);
+            }
+            return *this;
+        }
+
+        type& operator=(type&& other) noexcept(AllocTraits::propagate_on_container_move_assignment::value ||
+                                               AllocTraits::is_always_equal::value) {
+            clear();
+
+            if (AllocTraits::propagate_on_container_move_assignment::value ||
+                get_allocator() == other.get_allocator()) {
+                releaseChunks(0);
+                chunks = std::move(other.chunks);
+                count = other.count;
+                other.count = 0;
+            } else {
+                assignSlots(std::move(other));
+                other.clear();
+            }
+            return *this;
+        }
+
+        ~type() {
+            clear();
+            releaseChunks(0);
+        }
+
+        Allocator get_allocator() const { return Allocator(chunks.get_allocator()); }
+
+        Link& link(Index index) { return node(index).link; }
+        const Link& link(Index index) const { return node(index).link; }
+
+        T& value(Index index) { return node(index).data.get(); }
+        const T& value(Index index) const { return node(index).data.get(); }
+
+        template <typename... Args>
+        Index emplace_back(Args&&... args) {
+            if (count == capacity()) {
+                addChunk();
+            }
+
+            Index index = static_cast<Index>(count);
+            Allocator alloc = get_allocator();
+            node(index).data.construct(alloc, std::forward<Args>(args)...);
+            node(index).link = Link();
+            count++;
+            return index;
+        }
+
+        template <typename... Args>
+        void construct(Index index, Args&&... args) {
+            Allocator alloc = get_allocator();
+            node(index).data.construct(alloc, std::forward<Args>(args)...);
+        }
+
+        void destroy(Index index) {
+            Allocator alloc = get_allocator();
+            node(index).data.destroy(alloc);
+        }
+
+        void swap_slots(Index a, Index b) {
+            using std::swap;
+            swap(node(a).data.get(), node(b).data.get());
+            swap(node(a).link, node(b).link);
+        }
+
+        void swap(type& other) noexcept {
+            chunks.swap(other.chunks);
+            std::swap(count, other.count);
+        }
+
+        size_t size() const noexcept { return count; }
+        size_t capacity() const noexcept { return chunks.size() << ChunkBits; }
+        size_t max_size() const noexcept { return std::numeric_limits<size_t>::max() >> 1; }
+
+        void reserve(size_t n) {
+            chunks.reserve((n + chunkSize - 1) >> ChunkBits);
+            while (capacity() < n) {
+                addChunk();
+            }
+        }
+
+        void shrink_to_fit() {
+            releaseChunks((count + chunkSize - 1) >> ChunkBits);
+            chunks.shrink_to_fit();
+        }
+
+        // Keeps every chunk, like the other storages keep their capacity;
+        // shrink_to_fit() hands them back.
+        void clear() {
+            for (size_t i = 0; i < count; ++i) {
+                if (isLive(i)) {
+                    destroy(static_cast<Index>(i));
+                }
+            }
+            count = 0;
+        }
+
+    private:
+        static constexpr size_t chunkSize = size_t(1) << ChunkBits;
+        static constexpr size_t chunkMask = chunkSize - 1;
+
+        Node& node(Index index) {
+            return chunks[index >> ChunkBits][index & chunkMask];
+        }
+
+        const Node& node(Index index) const {
+            return chunks[index >> ChunkBits][index & chunkMask];
+        }
+
+        bool isLive(size_t index) const {
+            return !link(static_cast<Index>(index)).isFree(static_cast<Index>(index));
+        }
+
+        // Nodes only hold raw payload bytes and plain links, so chunks are
+        // released without running destructors.
+        void addChunk() {
+            NodeAllocator alloc(chunks.get_allocator());
+            chunks.push_back(nullptr);
+
+            try {
+                chunks.back() = NodeTraits::allocate(alloc, chunkSize);
+            } catch (...) {
+                chunks.pop_back();
+                throw;
+            }
+
+            std::uninitialized_default_construct_n(chunks.back(), chunkSize);
+        }
+
+        void releaseChunks(size_t keep) {
+            NodeAllocator alloc(chunks.get_allocator());
+            for (size_t i = keep; i < chunks.size(); ++i) {
+                NodeTraits::deallocate(alloc, chunks[i], chunkSize);
+            }
+            chunks.resize(std::min(keep, chunks.size()));
+        }
+
+        // See InterleavedStorage::assignSlots
+        template <typename Other>
+        void assignSlots(Other&& other) {
+            Allocator alloc = get_allocator();
+            reserve(other.count);
+
+            try {
+                for (size_t i = 0; i < other.count; ++i) {
+                    Index index = static_cast<Index>(i);
+                    if (other.isLive(i)) {
+                        if constexpr (std::is_lvalue_reference<Other>::value) {
+                            node(index).data.construct(alloc, other.value(index));
+                        } else {
+                            node(index).data.construct(alloc, std::move(other.value(index)));
+                        }
+                    }
+                    node(index).link = other.link(index);
+                    count++;
+                }
+            } catch (...) {
+                clear();
+                throw;
+            }
+        }
+
+        Chunks chunks;
+        size_t count;
+    };
+};
+
+// Vector of trivially copyable entries whose first InlineCount entries are
+// kept inside the object. Once it outgrows them, all entries move to the
+// heap together. FreeList keeps its per-slot side tables in it under
+// SmallStorage, so that small lists stay free of allocations.
+template<typename U, size_t InlineCount, typename Allocator = std::allocator<U>>
+class SmallSideTable {
+    static_assert(std::is_trivially_copyable<U>::value, "SmallSideTable entries must be trivially copyable");
+
+    using Heap = std::vector<U, Allocator>;
+
+public:
+    using allocator_type = Allocator;
+
+    explicit SmallSideTable(const Allocator& alloc = Allocator()) : heap(alloc), count(0) {}
+
+    SmallSideTable(size_t n, const U& value, const Allocator& alloc = Allocator()) : SmallSideTable(alloc) {
+        resize(n, value);
+    }
+
+    SmallSideTable(const SmallSideTable& other) : heap(other.heap), count(other.count) {
+        std::copy_n(other.local, InlineCount, local);
+    }
+
+    SmallSideTable(const SmallSideTable& other, const Allocator& alloc)
+        : heap(other.heap, alloc), count(other.count) {
+        std::copy_n(other.local, InlineCount, local);
+    }
+
+    SmallSideTable(SmallSideTable&& other) noexcept : heap(std::move(other.heap)), count(other.count) {
+        std::copy_n(other.local, InlineCount, local);
+        other.clear();
+    }
+
+    SmallSideTable(SmallSideTable&& other, const Allocator& alloc)
+        : heap(std::move(other.heap), alloc), count(other.count) {
+        std::copy_n(other.local, InlineCount, local);
+        other.clear();
+    }
+
+    SmallSideTable& operator=(const SmallSideTable& other) {
+        heap = other.heap;
+        count = other.count;
+        std::copy_n(other.local, InlineCount, local);
+        return *this;
+    }
+
+    SmallSideTable& operator=(SmallSideTable&& other) {
+        if (this != &other) {
+            heap = std::move(other.heap);
+            count = other.count;
+            std::copy_n(other.local, InlineCount, local);
+            other.clear();
+        }
+        return *this;
+    }
+
+    Allocator get_allocator() const { return heap.get_allocator(); }
+
+    size_t size() const noexcept { return heap.empty() ? count : heap.size(); }
+    bool empty() const noexcept { return size() == 0; }
+
+    U* begin() noexcept { return heap.empty() ? local : heap.data(); }
+    const U* begin() const noexcept { return heap.empty() ? local : heap.data(); }
+    U* end() noexcept { return begin() + size(); }
+    const U* end() const noexcept { return begin() + size(); }
+
+    U& operator[](size_t index) { return begin()[index]; }
+    const U& operator[](size_t index) const { return begin()[index]; }
+
+    U& back() { return begin()[size() - 1]; }
+    const U& back() const { return begin()[size() - 1]; }
+
+    void resize(size_t n, const U& value) {
+        if (heap.empty() && n <= InlineCount) {
+            if (n > count) {
+                std::fill(local + count, local + n, value);
+            }
+            count = n;
+            return;
+        }
+
+        if (heap.empty()) {
+            heap.reserve(n);
+            heap.assign(local, local + count);
+        }
+        heap.resize(n, value);
+        count = 0;
+    }
+
+    void clear() noexcept {
+        heap.clear();
+        count = 0;
+    }
+
+    void swap(SmallSideTable& other) noexcept {
+        std::swap_ranges(local, local + InlineCount, other.local);
+        heap.swap(other.heap);
+        std::swap(count, other.count);
+    }
+
+private:
+    U local[InlineCount] {};
+    // Holds every entry once the table has spilled, and nothing before
+    Heap heap;
+    // Number of inline entries while heap is empty
+    size_t count;
+};
+
+// Small-buffer storage: the first InlineSlots slots are kept inside the list
+// object and only later slots go to a heap array, so a list that stays that
+// small never allocates. Inline slots never move and an index names the
+// same slot before and after the list spills, so iterators stay valid
+// across the spill. The price is that moving or swapping the list has to
+// move the inline payloads one by one.
+template<size_t InlineSlots>
+struct SmallStorage {
+    static_assert(InlineSlots > 0, "SmallStorage needs at least one inline slot");
+
+    template<typename T, typename Index, typename Allocator = std::allocator<T>>
+    class type {
+        struct Node {
+            FreeListSlot<T> data;
+            FreeListLink<Index> link;
+
+            Node() : link() {}
+        };
+
+        using AllocTraits = std::allocator_traits<Allocator>;
+        using Nodes = std::vector<Node, typename AllocTraits::template rebind_alloc<Node>>;
+
+    public:
+        using Link = FreeListLink<Index>;
+
+        // FreeList keeps the liveness bits and generations of the inline
+        // slots inline too
+        template<typename U, size_t SlotsPerEntry, typename A>
+        using SideTable = SmallSideTable<U, (InlineSlots + SlotsPerEntry - 1) / SlotsPerEntry, A>;
+
+        type() : type(Allocator()) {}
+
+        explicit type(const Allocator& alloc) : heap(typename Nodes::allocator_type(alloc)), count(0) {}
+
+        type(const type& other)
+            : type(other, AllocTraits::select_on_container_copy_construction(other.get_allocator())) {}
+
+        type(const type& other, const Allocator& alloc) : type(alloc) {
+            assignSlots(other);
+        }
+
+        type(type&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+            : heap(std::move(other.heap)), count(other.count) {
+            takeInline(other);
+        }
+
+        type(type&& other, const Allocator& alloc) : type(alloc) {
+            if (get_allocator() == other.get_allocator()) {
+                heap.swap(other.heap);
+                count = other.count;
+                takeInline(other);
+            } else {
+                assignSlots(std::move(other));
+                other.clear();
+            }
+        }
+
+        type& operator=(const type& other) {
+            if (this != &other) {
+                type copy(other, AllocTraits::propagate_on_container_copy_assignment::value
+                                     ? other.get_allocator() : get_allocator());
+                swap(copy);
+            }
+            return *this;
+        }
+
+        type& operator=(type&& other) {
+            if (this == &other) return *this;
+
+            clear();
+
+            if (AllocTraits::propagate_on_container_move_assignment::value ||
+                get_allocator() == other.get_allocator()) {
+                heap = std::move(other.heap);
+                count = other.count;
+                takeInline(other);
+            } else {
+                assignSlots(std::move(other));
+                other.clear();
+            }
+            return *this;
+        }
+
+        ~type() {
+            clear();
+        }
+
+        Allocator get_allocator() const { return Allocator(heap.get_allocator()); }
+
+        Link& link(Index index) { return node(index).link; }
+        const Link& link(Index index) const { return node(index).link; }
+
+        T& value(Index index) { return node(index).data.get(); }
+        const T& value(Index index) const { return node(index).data.get(); }
+
+        template <typename... Args>
+        Index emplace_back(Args&&... args) {
+            Index index = static_cast<Index>(count);
+            Allocator alloc = get_allocator();
+
+            if (count < InlineSlots) {
+                local[count].data.construct(alloc, std::forward<Args>(args)...);
+                local[count].link = Link();
+            } else if (heap.size() == heap.capacity()) {
+                // Construct before relocating, `args` may refer to an element
+                Nodes grown(heap.get_allocator());
+                grown.reserve(std::max(InlineSlots, heap.capacity() * 2));
+                grown.resize(heap.size() + 1);
+                grown.back().data.construct(alloc, std::forward<Args>(args)...);
+                moveInto(grown);
+            } else {
+                heap.emplace_back();
+
+                try {
+                    heap.back().data.construct(alloc, std::forward<Args>(args)...);
+                } catch (...) {
+                    heap.pop_back();
+                    throw;
+                }
+            }
+
+            count++;
+            return index;
+        }
+
+        template <typename... Args>
+        void construct(Index index, Args&&... args) {
+            Allocator alloc = get_allocator();
+            node(index).data.construct(alloc, std::forward<Args>(args)...);
+        }
+
+        void destroy(Index index) {
+            Allocator alloc = get_allocator();
+            node(index).data.destroy(alloc);
+        }
+
+        void swap_slots(Index a, Index b) {
+            using std::swap;
+            swap(node(a).data.get(), node(b).data.get());
+            swap(node(a).link, node(b).link);
+        }
+
+        // Inline slots cannot change owner, so their payloads are exchanged
+        void swap(type& other) noexcept(std::is_nothrow_move_constructible<T>::value &&
+                                        std::is_nothrow_swappable<T>::value) {
+            Allocator alloc = get_allocator();
+            size_t common = std::min(InlineSlots, std::max(count, other.count));
+
+            for (size_t i = 0; i < common; ++i) {
+                bool mine = i < count && isLive(i);
+                bool theirs = i < other.count && other.isLive(i);
+
+                if (mine && theirs) {
+                    using std::swap;
+                    swap(local[i].data.get(), other.local[i].data.get());
+                } else if (mine) {
+                    other.local[i].data.construct(alloc, std::move(local[i].data.get()));
+                    local[i].data.destroy(alloc);
+                } else if (theirs) {
+                    local[i].data.construct(alloc, std::move(other.local[i].data.get()));
+                    other.local[i].data.destroy(alloc);
+                }
+
+                std::swap(local[i].link, other.local[i].link);
+            }
+
+            heap.swap(other.heap);
+            std::swap(count, other.count);
+        }
+
+        size_t size() const noexcept { return count; }
+        size_t capacity() const noexcept { return InlineSlots + heap.capacity(); }
+        size_t max_size() const noexcept { return InlineSlots + heap.max_size(); }
+
+        void reserve(size_t n) {
+            if (n > capacity()) {
+                relocate(n - InlineSlots);
+            }
+        }
+
+        // Gives the heap array back entirely once everything fits inline
+        void shrink_to_fit() {
+            if (heap.size() < heap.capacity()) {
+                relocate(heap.size());
+            }
+        }
+
+        void clear() {
+            for (size_t i = 0; i < count; ++i) {
+                if (isLive(i)) {
+                    destroy(static_cast<Index>(i));
+                }
+            }
+            heap.clear();
+            count = 0;
+        }
+
+    private:
+        Node& node(Index index) {
+            return (index < InlineSlots) ? local[index] : heap[index - InlineSlots];
+        }
+
+        const Node& node(Index index) const {
+            return (index < InlineSlots) ? local[index] : heap[index - InlineSlots];
+        }
+
+        bool isLive(size_t index) const {
+            return !link(static_cast<Index>(index)).isFree(static_cast<Index>(index));
+        }
+
+        // Moves the inline slots of `other` into this storage, whose count
+        // and heap have already been taken over, and leaves `other` empty.
+        void takeInline(type& other) {
+            Allocator alloc = get_allocator();
+
+            for (size_t i = 0; i < std::min(count, InlineSlots); ++i) {
+                local[i].link = other.local[i].link;
+                if (isLive(i)) {
+                    local[i].data.construct(alloc, std::move(other.local[i].data.get()));
+                    other.local[i].data.destroy(alloc);
+                }
+            }
+
+            other.count = 0;
+        }
+
+        // See InterleavedStorage::assignSlots
+        template <typename Other>
+        void assignSlots(Other&& other) {
+            Allocator alloc = get_allocator();
+            reserve(other.count);
+
+            try {
+                for (size_t i = 0; i < other.count; ++i) {
+                    Index index = static_cast<Index>(i);
+                    if (i >= InlineSlots) {
+                        heap.emplace_back();
+                    }
+                    node(index).link = other.link(index);
+                    count++;
+
+                    if (other.isLive(i)) {
+                        try {
+                            if constexpr (std::is_lvalue_reference<Other>::value) {
+                                node(index).data.construct(alloc, other.value(index));
+                            } else {
+                                node(index).data.construct(alloc, std::move(other.value(index)));
+                            }
+                        } catch (...) {
+                            node(index).link.prev = index;
+                            throw;
+                        }
+                    }
+                }
+            } catch (...) {
+                clear();
+                throw;
+            }
+        }
+
+        // See InterleavedStorage::moveInto
+        void moveInto(Nodes& grown) {
+            Allocator alloc = get_allocator();
+            for (size_t i = 0; i < heap.size(); ++i) {
+                if (isLive(InlineSlots + i)) {
+                    grown[i].data.construct(alloc, std::move(heap[i].data.get()));
+                    heap[i].data.destroy(alloc);
+                }
+                grown[i].link = heap[i].link;
+            }
+
+            heap.swap(grown);
+        }
+
+        void relocate(size_t heapSlots) {
+            Nodes grown(heap.get_allocator());
+            grown.reserve(heapSlots);
+            grown.resize(heap.size());
+            moveInto(grown);
+        }
+
+        Node local[InlineSlots];
+        // Slots InlineSlots and up
+        Nodes heap;
+        size_t count;
+    };
+};
+
+// Container FreeList keeps a per-slot side table in (liveness bits,
+// generations), holding one entry per SlotsPerEntry slots. A storage can
+// supply its own through a nested SideTable alias; std::vector otherwise.
+template<typename Storage, typename U, size_t SlotsPerEntry, typename Allocator, typename = void>
+struct FreeListSideTable {
+    using type = std::vector<U, Allocator>;
+};
+
+template<typename Storage, typename U, size_t SlotsPerEntry, typename Allocator>
+struct FreeListSideTable<Storage, U, SlotsPerEntry, Allocator,
+                         std::void_t<typename Storage::template SideTable<U, SlotsPerEntry, Allocator>>> {
+    using type = typename Storage::template SideTable<U, SlotsPerEntry, Allocator>;
+};
+
+#endif
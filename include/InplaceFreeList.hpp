@@ -0,0 +1,758 @@
+#ifndef INPLACE_FREELIST_HPP
+#define INPLACE_FREELIST_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include "FreeListStorage.hpp"
+
+// Narrowest unsigned type that can address N slots and still keep its
+// largest value free for npos.
+template<size_t N>
+using InplaceIndex =
+    typename std::conditional<(N < std::numeric_limits<uint8_t>::max()), uint8_t,
+    typename std::conditional<(N < std::numeric_limits<uint16_t>::max()), uint16_t,
+    typename std::conditional<(N < std::numeric_limits<uint32_t>::max()), uint32_t,
+                              uint64_t>::type>::type>::type;
+
+// Slots, links and bookkeeping of an InplaceFreeList. Trivial payloads are
+// kept in a plain array and assigned into place, which keeps the whole
+// list a literal type usable in constant expressions. Other payloads live
+// in raw slots and are constructed and destroyed explicitly, which needs a
+// user-provided destructor and so cannot be constexpr before C++20.
+template<typename T, typename Index, size_t N, bool = std::is_trivial<T>::value>
+class InplaceFreeListBase {
+protected:
+    static constexpr Index npos = std::numeric_limits<Index>::max();
+
+    struct Link {
+        Index next = npos;
+        Index prev = npos;
+    };
+
+    constexpr InplaceFreeListBase() = default;
+    constexpr InplaceFreeListBase(const InplaceFreeListBase&) = default;
+    constexpr InplaceFreeListBase& operator=(const InplaceFreeListBase&) = default;
+
+    // Moved-from lists are left empty, as FreeList's are
+    constexpr InplaceFreeListBase(InplaceFreeListBase&& other) noexcept
+        : InplaceFreeListBase(static_cast<const InplaceFreeListBase&>(other)) {
+        other.reset();
+    }
+
+    constexpr InplaceFreeListBase& operator=(InplaceFreeListBase&& other) noexcept {
+        if (this != &other) {
+            *this = static_cast<const InplaceFreeListBase&>(other);
+            other.reset();
+        }
+        return *this;
+    }
+
+    constexpr T& value(Index index) { return values[index]; }
+    constexpr const T& value(Index index) const { return values[index]; }
+
+    template <typename... Args>
+    constexpr void construct(Index index, Args&&... args) {
+        values[index] = T(std::forward<Args>(args)...);
+    }
+
+    constexpr void destroy(Index) {}
+
+    // Nothing to destroy, so forgetting every slot is enough
+    constexpr void reset() {
+        head = tail = freeHead = npos;
+        used = size_ = 0;
+    }
+
+    T values[N] {};
+    Link links[N] {};
+    Index head = npos;
+    Index tail = npos;
+    // Free chain through the next links of freed slots
+    Index freeHead = npos;
+    // Slots [used, N) have never been handed out
+    Index used = 0;
+    Index size_ = 0;
+};
+
+template<typename T, typename Index, size_t N>
+class InplaceFreeListBase<T, Index, N, false> {
+protected:
+    static constexpr Index npos = std::numeric_limits<Index>::max();
+
+    struct Link {
+        Index next = npos;
+        Index prev = npos;
+    };
+
+    InplaceFreeListBase() = default;
+
+    InplaceFreeListBase(const InplaceFreeListBase& other) {
+        assignFrom(other);
+    }
+
+    InplaceFreeListBase(InplaceFreeListBase&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        assignFrom(std::move(other));
+        other.reset();
+    }
+
+    InplaceFreeListBase& operator=(const InplaceFreeListBase& other) {
+        if (this != &other) {
+            reset();
+            assignFrom(other);
+        }
+        return *this;
+    }
+
+    InplaceFreeListBase& operator=(InplaceFreeListBase&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if (this != &other) {
+            reset();
+            assignFrom(std::move(other));
+            other.reset();
+        }
+        return *this;
+    }
+
+    ~InplaceFreeListBase() {
+        reset();
+    }
+
+    T& value(Index index) { return values[index].get(); }
+    const T& value(Index index) const { return values[index].get(); }
+
+    template <typename... Args>
+    void construct(Index index, Args&&... args) {
+        std::allocator<T> alloc;
+        values[index].construct(alloc, std::forward<Args>(args)...);
+    }
+
+    void destroy(Index index) {
+        std::allocator<T> alloc;
+        values[index].destroy(alloc);
+    }
+
+    // Destroys every live payload and forgets all slots
+    void reset() {
+        for (Index index = 0; index < used; ++index) {
+            if (links[index].prev != index) {
+                destroy(index);
+            }
+        }
+
+        head = tail = freeHead = npos;
+        used = size_ = 0;
+    }
+
+    FreeListSlot<T> values[N];
+    Link links[N] {};
+    Index head = npos;
+    Index tail = npos;
+    Index freeHead = npos;
+    Index used = 0;
+    Index size_ = 0;
+
+private:
+    // Copies or moves the payloads of `other` into the same slots, so the
+    // copy has the same layout. Expects this list to be empty.
+    template <typename Other>
+    void assignFrom(Other&& other) {
+        Index index = 0;
+
+        try {
+            for (; index < other.used; ++index) {
+                links[index] = other.links[index];
+
+                if (other.links[index].prev != index) {
+                    using Source = typename std::conditional<std::is_lvalue_reference<Other>::value, const T&, T&&>::type;
+                    construct(index, static_cast<Source>(other.value(index)));
+                }
+            }
+        } catch (...) {
+            used = index;
+            reset();
+            throw;
+        }
+
+        head = other.head;
+        tail = other.tail;
+        freeHead = other.freeHead;
+        used = other.used;
+        size_ = other.size_;
+    }
+};
+
+// Fixed-capacity FreeList whose N slots live inside the object itself, so
+// it never touches the heap. Links use the narrowest index type that fits
+// N. Freed slots are reused most recent first, as with LifoSlots.
+//
+// A full list reports overflow instead of growing: push_front/push_back
+// return false, emplace_front/emplace_back return nullptr, emplace/insert
+// return end(), and nothing is inserted. Range insertions and the sized
+// constructors are all-or-nothing. Overflow never throws or allocates.
+//
+// For trivial T every member is constexpr, so lists can be built, sorted
+// and traversed in constant expressions.
+template<typename T, size_t N>
+class InplaceFreeList : private InplaceFreeListBase<T, InplaceIndex<N>, N> {
+    static_assert(N > 0, "InplaceFreeList capacity must be positive");
+
+    using Base = InplaceFreeListBase<T, InplaceIndex<N>, N>;
+    using Base::values;
+    using Base::links;
+    using Base::head;
+    using Base::tail;
+    using Base::freeHead;
+    using Base::used;
+    using Base::size_;
+    using Base::value;
+    using Base::construct;
+    using Base::destroy;
+    using Base::reset;
+
+public:
+    using Index = InplaceIndex<N>;
+    static constexpr Index npos = Base::npos;
+
+private:
+    using Link = typename Base::Link;
+
+    constexpr Link& link(Index index) { return links[index]; }
+    constexpr const Link& link(Index index) const { return links[index]; }
+
+    // Takes a free slot and builds the payload in it, or returns npos when
+    // the list is full.
+    template <typename... Args>
+    constexpr Index allocateNode(Args&&... args) {
+        Index index = npos;
+
+        if (freeHead != npos) {
+            index = freeHead;
+            construct(index, std::forward<Args>(args)...);
+            freeHead = link(index).next;
+        } else if (used < N) {
+            index = used;
+            construct(index, std::forward<Args>(args)...);
+            used++;
+        } else {
+            return npos;
+        }
+
+        size_++;
+        return index;
+    }
+
+    // Links a freshly allocated node in front of `pos`, or at the tail when
+    // `pos` is npos.
+    constexpr void linkBefore(Index pos, Index index) {
+        Index prevIndex = (pos == npos) ? tail : link(pos).prev;
+
+        link(index).next = pos;
+        link(index).prev = prevIndex;
+
+        if (prevIndex == npos) {
+            head = index;
+        } else {
+            link(prevIndex).next = index;
+        }
+
+        if (pos == npos) {
+            tail = index;
+        } else {
+            link(pos).prev = index;
+        }
+    }
+
+    constexpr void remove(Index index) {
+        Index nextIndex = link(index).next;
+        Index prevIndex = link(index).prev;
+
+        if (prevIndex == npos) {
+            head = nextIndex;
+        } else {
+            link(prevIndex).next = nextIndex;
+        }
+
+        if (nextIndex == npos) {
+            tail = prevIndex;
+        } else {
+            link(nextIndex).prev = prevIndex;
+        }
+
+        destroy(index);
+        link(index).prev = index;
+        link(index).next = freeHead;
+        freeHead = index;
+        size_--;
+    }
+
+    // Stable merge of two next-linked runs; `left` wins ties.
+    template <typename Compare>
+    constexpr Index merge(Index left, Index right, const Compare& comp) {
+        if (left == npos) return right;
+        if (right == npos) return left;
+
+        Index result = npos;
+        if (comp(value(right), value(left))) {
+            result = right;
+            right = link(right).next;
+        } else {
+            result = left;
+            left = link(left).next;
+        }
+
+        Index last = result;
+        while (left != npos && right != npos) {
+            if (comp(value(right), value(left))) {
+                link(last).next = right;
+                last = right;
+                right = link(right).next;
+            } else {
+                link(last).next = left;
+                last = left;
+                left = link(left).next;
+            }
+        }
+
+        link(last).next = (left != npos) ? left : right;
+        return result;
+    }
+
+public:
+    using value_type = T;
+
+    class Iterator {
+        friend class InplaceFreeList;
+        friend class ConstIterator;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = T;
+        using pointer = T*;
+        using reference = T&;
+
+        constexpr Iterator() : list(nullptr), index(npos) {}
+
+        constexpr Iterator(InplaceFreeList* list, Index index)
+            : list(list), index(index) {}
+
+        constexpr reference operator*() const {
+            return list->value(index);
+        }
+
+        constexpr pointer operator->() const {
+            return &list->value(index);
+        }
+
+        constexpr Iterator& operator++() {
+            index = list->link(index).next;
+            return *this;
+        }
+
+        constexpr Iterator operator++(int) {
+            Iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        constexpr Iterator& operator--() {
+            index = (index == npos) ? list->tail : list->link(index).prev;
+            return *this;
+        }
+
+        constexpr Iterator operator--(int) {
+            Iterator temp = *this;
+            --(*this);
+            return temp;
+        }
+
+        constexpr bool operator==(const Iterator& other) const {
+            return (index == other.index) && (list == other.list);
+        }
+
+        constexpr bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        InplaceFreeList* list;
+        Index index;
+    };
+
+    class ConstIterator {
+        friend class InplaceFreeList;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = T;
+        using pointer = const T*;
+        using reference = const T&;
+
+        constexpr ConstIterator() : list(nullptr), index(npos) {}
+
+        constexpr ConstIterator(const InplaceFreeList* list, Index index)
+            : list(list), index(index) {}
+
+        constexpr ConstIterator(const Iterator& it)
+            : list(it.list), index(it.index) {}
+
+        constexpr reference operator*() const {
+            return list->value(index);
+        }
+
+        constexpr pointer operator->() const {
+            return &list->value(index);
+        }
+
+        constexpr ConstIterator& operator++() {
+            index = list->link(index).next;
+            return *this;
+        }
+
+        constexpr ConstIterator operator++(int) {
+            ConstIterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        constexpr ConstIterator& operator--() {
+            index = (index == npos) ? list->tail : list->link(index).prev;
+            return *this;
+        }
+
+        constexpr ConstIterator operator--(int) {
+            ConstIterator temp = *this;
+            --(*this);
+            return temp;
+        }
+
+        constexpr bool operator==(const ConstIterator& other) const {
+            return (index == other.index) && (list == other.list);
+        }
+
+        constexpr bool operator!=(const ConstIterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        const InplaceFreeList* list;
+        Index index;
+    };
+
+    using iterator = Iterator;
+    using const_iterator = ConstIterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    constexpr InplaceFreeList() = default;
+
+    constexpr explicit InplaceFreeList(size_t count) {
+        insert(end(), count, T());
+    }
+
+    constexpr InplaceFreeList(size_t count, const T& value) {
+        insert(end(), count, value);
+    }
+
+    template<class InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    constexpr InplaceFreeList(InputIt first, InputIt last) {
+        insert(end(), first, last);
+    }
+
+    constexpr InplaceFreeList(std::initializer_list<T> init) {
+        insert(end(), init);
+    }
+
+    constexpr iterator begin() noexcept { return iterator(this, head); }
+    constexpr iterator end() noexcept { return iterator(this, npos); }
+    constexpr const_iterator begin() const noexcept { return const_iterator(this, head); }
+    constexpr const_iterator end() const noexcept { return const_iterator(this, npos); }
+    constexpr const_iterator cbegin() const noexcept { return begin(); }
+    constexpr const_iterator cend() const noexcept { return end(); }
+    constexpr reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    constexpr reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    constexpr const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    constexpr const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    constexpr const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    constexpr const_reverse_iterator crend() const noexcept { return rend(); }
+
+    template <typename U>
+    constexpr bool push_front(U&& data) {
+        return emplace(cbegin(), std::forward<U>(data)) != end();
+    }
+
+    template <typename U>
+    constexpr bool push_back(U&& data) {
+        return emplace(cend(), std::forward<U>(data)) != end();
+    }
+
+    template<class... Args>
+    constexpr iterator emplace(const_iterator pos, Args&&... args) {
+        Index index = allocateNode(std::forward<Args>(args)...);
+        if (index == npos) return end();
+
+        linkBefore(pos.index, index);
+        return iterator(this, index);
+    }
+
+    template<typename... Args>
+    constexpr T* emplace_front(Args&&... args) {
+        iterator it = emplace(cbegin(), std::forward<Args>(args)...);
+        return (it == end()) ? nullptr : &*it;
+    }
+
+    template<typename... Args>
+    constexpr T* emplace_back(Args&&... args) {
+        iterator it = emplace(cend(), std::forward<Args>(args)...);
+        return (it == end()) ? nullptr : &*it;
+    }
+
+    template <typename U>
+    constexpr iterator insert(const_iterator pos, U&& data) {
+        return emplace(pos, std::forward<U>(data));
+    }
+
+    constexpr iterator insert(const_iterator pos, size_t count, const T& data) {
+        if (count > N - size_) return end();
+
+        iterator first(this, pos.index);
+        for (size_t k = 0; k < count; ++k) {
+            iterator it = emplace(pos, data);
+            if (k == 0) first = it;
+        }
+        return first;
+    }
+
+    // Forward ranges are checked against the remaining capacity up front;
+    // a single-pass range that overflows part way is rolled back.
+    template<class InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    constexpr iterator insert(const_iterator pos, InputIt first, InputIt last) {
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+
+        if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value) {
+            if (static_cast<size_t>(std::distance(first, last)) > N - size_) return end();
+        }
+
+        iterator result(this, pos.index);
+        for (bool isFirst = true; first != last; ++first, isFirst = false) {
+            iterator it = emplace(pos, *first);
+
+            if (it == end()) {
+                erase(result, iterator(this, pos.index));
+                return end();
+            }
+            if (isFirst) result = it;
+        }
+        return result;
+    }
+
+    constexpr iterator insert(const_iterator pos, std::initializer_list<T> ilist) {
+        return insert(pos, ilist.begin(), ilist.end());
+    }
+
+    constexpr iterator erase(const_iterator pos) {
+        Index next = link(pos.index).next;
+        remove(pos.index);
+        return iterator(this, next);
+    }
+
+    constexpr iterator erase(const_iterator first, const_iterator last) {
+        while (first != last) {
+            first = erase(first);
+        }
+        return iterator(this, last.index);
+    }
+
+    constexpr iterator find(const T& target) {
+        for (Index curr = head; curr != npos; curr = link(curr).next) {
+            if (value(curr) == target) return iterator(this, curr);
+        }
+        return end();
+    }
+
+    constexpr const_iterator find(const T& target) const {
+        for (Index curr = head; curr != npos; curr = link(curr).next) {
+            if (value(curr) == target) return const_iterator(this, curr);
+        }
+        return end();
+    }
+
+    template <typename Predicate>
+    constexpr size_t remove_if(Predicate pred) {
+        size_t removed = 0;
+
+        for (Index curr = head; curr != npos;) {
+            Index next = link(curr).next;
+
+            if (pred(value(curr))) {
+                remove(curr);
+                removed++;
+            }
+
+            curr = next;
+        }
+
+        return removed;
+    }
+
+    // Removes all but the first element of every run of equal elements.
+    template <typename BinaryPredicate = std::equal_to<T> >
+    constexpr size_t unique(BinaryPredicate pred = BinaryPredicate()) {
+        size_t removed = 0;
+
+        if (head == npos) return removed;
+
+        for (Index prev = head, curr = link(head).next; curr != npos;) {
+            Index next = link(curr).next;
+
+            if (pred(value(prev), value(curr))) {
+                remove(curr);
+                removed++;
+            } else {
+                prev = curr;
+            }
+
+            curr = next;
+        }
+
+        return removed;
+    }
+
+    // The same bottom-up bin merge sort as FreeList::sort: stable, and only
+    // the links move.
+    template <typename Compare = std::less<T> >
+    constexpr void sort(const Compare& comp = Compare()) {
+        if (head == npos) return;
+
+        constexpr size_t maxBins = std::numeric_limits<Index>::digits;
+        Index bins[maxBins] {};
+        size_t usedBins = 0;
+
+        for (Index first = head; first != npos;) {
+            Index run = first;
+            first = link(first).next;
+            link(run).next = npos;
+
+            size_t bin = 0;
+            for (; bin < usedBins && bins[bin] != npos; ++bin) {
+                run = merge(bins[bin], run, comp);
+                bins[bin] = npos;
+            }
+
+            if (bin == usedBins) {
+                usedBins++;
+            }
+            bins[bin] = run;
+        }
+
+        Index result = npos;
+        for (size_t bin = 0; bin < usedBins; ++bin) {
+            result = merge(bins[bin], result, comp);
+        }
+
+        Index prev = npos;
+        for (Index curr = result; curr != npos; curr = link(curr).next) {
+            link(curr).prev = prev;
+            prev = curr;
+        }
+
+        head = result;
+        tail = prev;
+    }
+
+    // Merges the sorted list `other` into this sorted list. Elements of this
+    // list come before equal elements of `other`, and `other` ends up empty.
+    // Returns false, leaving both lists untouched, when the result would not
+    // fit.
+    template <typename Compare = std::less<T> >
+    constexpr bool merge(InplaceFreeList& other, const Compare& comp = Compare()) {
+        if (&other == this) return true;
+        if (other.size_ > N - size_) return false;
+
+        Index curr = head;
+
+        for (Index from = other.head; from != npos; from = other.link(from).next) {
+            while (curr != npos && !comp(other.value(from), value(curr))) {
+                curr = link(curr).next;
+            }
+
+            linkBefore(curr, allocateNode(std::move(other.value(from))));
+        }
+
+        other.clear();
+        return true;
+    }
+
+    constexpr void reverse() noexcept {
+        for (Index curr = head; curr != npos; curr = link(curr).prev) {
+            Index next = link(curr).next;
+            link(curr).next = link(curr).prev;
+            link(curr).prev = next;
+        }
+
+        Index oldHead = head;
+        head = tail;
+        tail = oldHead;
+    }
+
+    constexpr const T& front() const { return value(head); }
+    constexpr const T& back() const { return value(tail); }
+    constexpr T& front() { return value(head); }
+    constexpr T& back() { return value(tail); }
+
+    constexpr void pop_front() {
+        if (head != npos) remove(head);
+    }
+
+    constexpr void pop_back() {
+        if (tail != npos) remove(tail);
+    }
+
+    constexpr bool empty() const noexcept {
+        return head == npos;
+    }
+
+    constexpr bool full() const noexcept {
+        return size_ == N;
+    }
+
+    constexpr size_t size() const noexcept {
+        return size_;
+    }
+
+    constexpr size_t max_size() const noexcept {
+        return N;
+    }
+
+    constexpr size_t capacity() const noexcept {
+        return N;
+    }
+
+    constexpr void clear() {
+        reset();
+    }
+
+    // Exchanges the contents element by element; the slots themselves
+    // cannot change owner.
+    constexpr void swap(InplaceFreeList& other) {
+        InplaceFreeList temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+};
+
+template<typename T, size_t N, typename Predicate>
+constexpr size_t erase_if(InplaceFreeList<T, N>& list, Predicate pred) {
+    return list.remove_if(pred);
+}
+
+#endif
@@ -1,3 +1,7 @@
+// Build: g++ -std=c++17 -O2 -Iinclude main.cpp -lpthread
+// Add -DFREELIST_PARALLEL_SORT -ltbb for the parallel sort checks and
+// benchmarks. They use std::execution::par, which libstdc++ runs on TBB,
+// and tbb::global_control to vary the thread count.
 #include <unordered_map>
 #include <iostream>
 #include <cassert>
@@ -6,30 +10,141 @@
 #include <random>
 #include <algorithm>
 #include <numeric>
+#include <cmath>
 #include <functional>
+#include <string>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <memory_resource>
+#include <optional>
 
+#ifdef FREELIST_PARALLEL_SORT
+#include <execution>
+#include <tbb/global_control.h>
+#endif
 #include "FreeList.hpp"
+#include "InplaceFreeList.hpp"
+#include "ConcurrentFreeList.hpp"
 
 using namespace std;
 
-class LFUCache {
+// All lists of the cache draw from one memory resource: nodeList passes its
+// allocator on to every bucket through uses-allocator construction of Node.
+// `Bucket` is the list type holding the entries of one frequency; most
+// buckets hold only a few, so by default the first four live inline and
+// creating or dropping a bucket does not allocate.
+// Keys are found through one open-addressing table, sized once for the
+// capacity and allocated from the same resource. Each slot holds iterators
+// to the key's bucket in nodeList and to its entry in that bucket, so a
+// lookup is a single probe sequence and the key itself is stored only
+// once, in its entry.
+template<typename K, typename V, typename Hash = std::hash<K>,
+         typename Bucket = SmallFreeList<pair<K,V>, 4, size_t, LifoSlots, pmr::polymorphic_allocator<pair<K,V>>>>
+class BasicLFUCache {
 private:
     struct Node {
-        FreeList<pair<int,int>> data;
+        using allocator_type = pmr::polymorphic_allocator<pair<K,V>>;
+
+        Bucket data;
         int freq;
         Node() : data(), freq(-1) {}
         Node(int f) : data(), freq(f) {}
+
+        explicit Node(const allocator_type& alloc) : data(alloc), freq(-1) {}
+        Node(int f, const allocator_type& alloc) : data(alloc), freq(f) {}
+        Node(const Node& other, const allocator_type& alloc) : data(other.data, alloc), freq(other.freq) {}
+        Node(Node&& other, const allocator_type& alloc) : data(std::move(other.data), alloc), freq(other.freq) {}
+    };
+
+    using NodeIt = typename PmrFreeList<Node>::iterator;
+    using EntryIt = typename Bucket::iterator;
+
+    // One key: `tag` is its mixed hash, 0 while the slot is empty
+    struct Slot {
+        size_t tag;
+        NodeIt node;
+        EntryIt entry;
     };
 
-    FreeList<Node> nodeList;
-    unordered_map<int,FreeList<Node>::iterator> keyLFU;
-    unordered_map<int,FreeList<pair<int,int>>::iterator> keyLRU;
+    PmrFreeList<Node> nodeList;
+    pmr::vector<Slot> index;
+    Hash hash;
     int cap;
     int size;
-    
+
+    // Finalizer of MurmurHash3, so identity hashes spread over the low bits
+    // the table indexes with
+    size_t tagOf(const K& key) const {
+        uint64_t h = static_cast<uint64_t>(hash(key));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb53fe6ae2ed3ull;
+        h ^= h >> 33;
+        return h == 0 ? 1 : static_cast<size_t>(h);
+    }
+
+    // The slot holding `key`, or the empty slot that ends its probe sequence
+    size_t probe(const K& key, size_t tag) const {
+        const size_t mask = index.size() - 1;
+        for (size_t i = tag & mask;; i = (i + 1) & mask) {
+            const Slot& slot = index[i];
+            if (slot.tag == 0 || (slot.tag == tag && slot.entry->first == key)) {
+                return i;
+            }
+        }
+    }
+
+    // Empties slot `hole` and shifts later keys of its cluster back, so no
+    // probe sequence ever crosses a gap and no tombstones are needed
+    void release(size_t hole) {
+        const size_t mask = index.size() - 1;
+        for (size_t i = (hole + 1) & mask; index[i].tag != 0; i = (i + 1) & mask) {
+            const size_t home = index[i].tag & mask;
+            if (((i - home) & mask) >= ((i - hole) & mask)) {
+                index[hole] = index[i];
+                hole = i;
+            }
+        }
+        index[hole].tag = 0;
+    }
+
+    // Moves the entry of `slot` to the bucket of the next frequency
+    void promote(Slot& slot) {
+        const auto currIt = slot.node;
+        const auto nextIt = next(currIt);
+        const auto entryIt = slot.entry;
+
+        const auto listIt = (nextIt == nodeList.end() || nextIt->freq != (currIt->freq+1))
+            ? nodeList.emplace(nextIt, currIt->freq+1)
+            : nextIt;
+
+        auto entry = std::move(*entryIt);
+        currIt->data.erase(entryIt);
+        if (currIt->data.empty()) {
+            nodeList.erase(currIt);
+        }
+
+        slot.node = listIt;
+        slot.entry = listIt->data.insert(listIt->data.end(), std::move(entry));
+    }
+
 public:
-    LFUCache(int capacity) : nodeList(), keyLFU(), keyLRU(), cap(capacity), size(0) {
+    BasicLFUCache(int capacity, pmr::memory_resource* resource = pmr::get_default_resource())
+        : nodeList(resource), index(resource), hash(), cap(capacity), size(0) {
 	nodeList.reserve(cap+1);
+
+        // Power of two at least 5/4 of the capacity: a full cache keeps
+        // the load factor between 0.4 and 0.8
+        size_t slots = 2;
+        while (slots < static_cast<size_t>(cap) + cap / 4 + 1) {
+            slots *= 2;
+        }
+        index.assign(slots, Slot{0, NodeIt(), EntryIt()});
     }
 
      void print() {
@@ -49,75 +164,233 @@ public:
         std::cout << std::endl;
     }   
 
-    int get(int key) {
-        const auto it = keyLFU.find(key);
-
-        if (it == keyLFU.end()) return -1;
+    // Defragments every bucket and the frequency list, then rebuilds the
+    // index, since every position in it may have moved.
+    void compact() {
+        for (auto& node : nodeList) {
+            node.data.compact();
+        }
 
-        // First get the k,v pair; add to next node with freq+1; remove from current node
-        const auto currIt = it->second;
-        const auto nextIt = next(currIt);
-        const auto [_, value] = *keyLRU[key];
+        nodeList.compact();
+        nodeList.reserve(cap+1);
 
-        const auto listIt = (nextIt == nodeList.end() || nextIt->freq != (currIt->freq+1))
-            ? nodeList.insert(nextIt, Node(currIt->freq+1))
-            : nextIt;
-        
-        currIt->data.erase(keyLRU[key]);
-        if (currIt->data.empty()) {
-            nodeList.erase(currIt);
+        std::fill(index.begin(), index.end(), Slot{0, NodeIt(), EntryIt()});
+        for (auto listIt = nodeList.begin(); listIt != nodeList.end(); ++listIt) {
+            for (auto it = listIt->data.begin(); it != listIt->data.end(); ++it) {
+                const size_t tag = tagOf(it->first);
+                index[probe(it->first, tag)] = Slot{tag, listIt, it};
+            }
         }
-            
-        keyLRU[key] = listIt->data.insert(listIt->data.end(), {key,value});
-        keyLFU[key] = listIt;
+    }
+
+    // The value of `key`, counting the access, or nullopt on a miss
+    std::optional<V> get(const K& key) {
+        Slot& slot = index[probe(key, tagOf(key))];
+
+        if (slot.tag == 0) return std::nullopt;
+
+        std::optional<V> value(slot.entry->second);
+        promote(slot);
 
         return value;
     }
+
+    // Counts one access of `key` like get(); false if it is not cached
+    bool touch(const K& key) {
+        Slot& slot = index[probe(key, tagOf(key))];
+
+        if (slot.tag == 0) return false;
+
+        promote(slot);
+        return true;
+    }
+
+    // The value of `key` without counting the access. Only reads, so
+    // concurrent peeks are safe while nothing modifies the cache.
+    std::optional<V> peek(const K& key) const {
+        const Slot& slot = index[probe(key, tagOf(key))];
+
+        if (slot.tag == 0) return std::nullopt;
+
+        return slot.entry->second;
+    }
     
-    void put(int key, int value) {
+    void put(const K& key, const V& value) {
         if (cap == 0) return;
 
-        const auto it = keyLFU.find(key);
+        const size_t tag = tagOf(key);
+        size_t at = probe(key, tag);
 
-        if (it == keyLFU.end()) {
-            if (size == cap) { // Eject LRU from LFU
-                auto LFU = nodeList.begin();
-                auto [k,_] = LFU->data.front();
-                LFU->data.pop_front();
-                keyLRU.erase(k);
-                keyLFU.erase(k);
+        if (index[at].tag != 0) {
+            index[at].entry->second = value;
+            promote(index[at]);
+            return;
+        }
 
-                if (LFU->data.empty()) {
-                    nodeList.erase(LFU);
-                }
+        if (size == cap) { // Eject LRU from LFU
+            auto LFU = nodeList.begin();
+            const K& victim = LFU->data.front().first;
+            release(probe(victim, tagOf(victim)));
+            LFU->data.pop_front();
 
-                size--;
+            if (LFU->data.empty()) {
+                nodeList.erase(LFU);
             }
 
-            const auto listIt = (nodeList.empty() || nodeList.begin()->freq != 1)
-                ? nodeList.insert(nodeList.begin(), Node(1))
-                : nodeList.begin();
-            
-            keyLRU[key] = listIt->data.insert(listIt->data.end(), {key, value});
-            keyLFU[key] = listIt;
-            size++;
+            size--;
 
-            return;
+            // Releasing the victim may have shifted keys into the slot
+            at = probe(key, tag);
         }
 
-        // Increment in nodeList and update LFU/LRU iterators
-        const auto currIt = it->second;
-        const auto listIt = (next(currIt) == nodeList.end() || next(currIt)->freq != (currIt->freq+1))
-            ? nodeList.insert(next(currIt), Node(currIt->freq+1))
-            : next(currIt);
+        const auto listIt = (nodeList.empty() || nodeList.begin()->freq != 1)
+            ? nodeList.emplace(nodeList.begin(), 1)
+            : nodeList.begin();
 
-        currIt->data.erase(keyLRU[key]);
-        if (currIt->data.empty()) {
-            nodeList.erase(currIt);
+        const auto entryIt = listIt->data.insert(listIt->data.end(), {key, value});
+        index[at] = Slot{tag, listIt, entryIt};
+        size++;
+    }
+};
+
+// int keys and values, with -1 for a miss
+class LFUCache : public BasicLFUCache<int, int> {
+public:
+    using BasicLFUCache::BasicLFUCache;
+
+    int get(int key) {
+        return BasicLFUCache::get(key).value_or(-1);
+    }
+};
+
+// How ShardedLFUCache counts hits. `exact` applies every hit to the
+// frequency buckets at once, under the shard's exclusive lock. `buffered`
+// serves reads under a shared lock and records the hit in the shard's hit
+// buffer; the buffer is applied in one batch when it fills up or before the
+// shard's next write. Hits that arrive while the buffer is full and its
+// shard is busy are dropped, so frequencies are approximate.
+enum class LFUHitPolicy { exact, buffered };
+
+// Thread-safe LFU cache: keys are hashed to independent shards, each an
+// LFUCache over its own lists behind its own lock, so threads working on
+// different shards never wait for each other. The capacity is split
+// between the shards as evenly as it divides, and each evicts on its own,
+// so the key evicted is the least frequently used of its shard rather
+// than of the whole cache.
+// Buffered hits need default-constructible, copy-assignable keys.
+template<typename K, typename V, typename Hash = std::hash<K>>
+class ShardedLFUCache {
+private:
+    static constexpr size_t hitBufferSize = 64;
+
+    // One cache line per lock, so neighbouring shards do not false-share
+    struct alignas(64) Shard {
+        std::shared_mutex mutex;
+        BasicLFUCache<K, V, Hash> cache;
+        // Hits recorded since the last batch; slots past hitBufferSize
+        // were dropped
+        std::atomic<size_t> recorded;
+        K hits[hitBufferSize];
+
+        Shard(int capacity, pmr::memory_resource* resource) : cache(capacity, resource), recorded(0) {}
+
+        // Under the shared lock, which keeps batches out while readers
+        // fill their claimed slots. True once the buffer is full.
+        bool recordHit(const K& key) {
+            size_t slot = recorded.fetch_add(1, std::memory_order_relaxed);
+            if (slot < hitBufferSize) {
+                hits[slot] = key;
+            }
+            return slot + 1 >= hitBufferSize;
         }
-        
-        keyLRU[key] = listIt->data.insert(listIt->data.end(), {key,value});
-        keyLFU[key] = listIt;
+
+        // Under the exclusive lock. Keys evicted since their hit are skipped.
+        void applyHits() {
+            size_t count = std::min(recorded.load(std::memory_order_relaxed), hitBufferSize);
+            for (size_t i = 0; i < count; ++i) {
+                cache.touch(hits[i]);
+            }
+            recorded.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    unsigned shardBits;
+    LFUHitPolicy hitPolicy;
+    Hash hash;
+
+    // The high bits of a multiplicative mix pick the shard, leaving the
+    // low bits, which the shards' own tables use, evenly spread
+    Shard& shardOf(const K& key) {
+        uint64_t mixed = static_cast<uint64_t>(hash(key)) * 0x9E3779B97F4A7C15ull;
+        return *shards[shardBits == 0 ? 0 : mixed >> (64 - shardBits)];
+    }
+
+public:
+    // `shardCount` is rounded up to a power of two, then halved until no
+    // shard is left without a slot. A negative capacity counts as zero.
+    // The memory resource is shared by all shards and must be thread-safe.
+    ShardedLFUCache(int capacity, size_t shardCount = 2 * std::max(1u, std::thread::hardware_concurrency()),
+                    pmr::memory_resource* resource = pmr::get_default_resource(),
+                    LFUHitPolicy hitPolicy = LFUHitPolicy::exact)
+        : shardBits(0), hitPolicy(hitPolicy) {
+        const size_t slots = static_cast<size_t>(std::max(capacity, 0));
+        while ((size_t(1) << shardBits) < shardCount) {
+            shardBits++;
+        }
+        while (shardBits > 0 && (size_t(1) << shardBits) > slots) {
+            shardBits--;
+        }
+
+        // The first slots % count shards take one slot more, so the
+        // shares add up to exactly the capacity
+        size_t count = size_t(1) << shardBits;
+        size_t share = slots / count;
+        size_t extra = slots % count;
+        for (size_t i = 0; i < count; ++i) {
+            shards.push_back(std::make_unique<Shard>(static_cast<int>(share + (i < extra)), resource));
+        }
+    }
+
+    std::optional<V> get(const K& key) {
+        Shard& shard = shardOf(key);
+
+        if (hitPolicy == LFUHitPolicy::exact) {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            return shard.cache.get(key);
+        }
+
+        std::optional<V> value;
+        bool full = false;
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            value = shard.cache.peek(key);
+            if (value) {
+                full = shard.recordHit(key);
+            }
+        }
+
+        // Whoever finds the buffer full applies it, unless another thread
+        // holds the shard; the hits then wait for the next batch or write
+        if (full) {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex, std::try_to_lock);
+            if (lock.owns_lock()) {
+                shard.applyHits();
+            }
+        }
+
+        return value;
+    }
+
+    void put(const K& key, const V& value) {
+        Shard& shard = shardOf(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.applyHits();
+        shard.cache.put(key, value);
+    }
+
+    size_t shard_count() const noexcept {
+        return shards.size();
     }
 };
 
@@ -163,11 +436,14 @@ void test_performance() {
     
     std::list<int> stdList;
     FreeList<int> freeList;
+    FreeList<int, uint32_t> freeList32;
 
     freeList.reserve(count);
+    freeList32.reserve(count);
 
     double total = 0.0f;
     double total2 = 0.0f;
+    double total3 = 0.0f;
 
     std::cout << "Testing std::list with count == " << count << "\n";
     total += measure_insertion(stdList, count);
@@ -183,7 +459,15 @@ void test_performance() {
     freeList.clear();
     std::cout << "Total time: " << total2 << "\n\n";
 
+    std::cout << "Testing FreeList<int, uint32_t> with count == " << count << "\n";
+    total3 += measure_insertion(freeList32, count);
+    total3 += measure_iteration(freeList32);
+    total3 += measure_deletion(freeList32);
+    freeList32.clear();
+    std::cout << "Total time: " << total3 << "\n\n";
+
     std::cout << "FreeList was " << (total/total2) << " times faster\n";
+    std::cout << "FreeList<int, uint32_t> was " << (total/total3) << " times faster\n";
 
     std::cout << std::endl;
 }
@@ -327,6 +611,33 @@ void test_LFUCache() {
     t = obj->get(5);
     std::cout << "get(5) = " << t << ",  Expected 5\n";
     assert(t == 5);
+    delete obj;
+
+    // Every key hashing alike puts the whole cache in one probe cluster,
+    // which eviction keeps punching holes into; it must still evict and
+    // answer exactly like a cache with a real hash
+    struct Collide {
+        size_t operator()(int) const { return 7; }
+    };
+    BasicLFUCache<int, int> spread(16);
+    BasicLFUCache<int, int, Collide> clustered(16);
+    std::mt19937 gen(42);
+    for (int i = 0; i < 20000; ++i) {
+        int key = static_cast<int>(gen() % 40);
+        if (gen() % 3 == 0) {
+            spread.put(key, i);
+            clustered.put(key, i);
+        } else {
+            assert(spread.get(key) == clustered.get(key));
+        }
+        if (i % 5000 == 0) {
+            clustered.compact();
+        }
+    }
+    for (int key = 0; key < 40; ++key) {
+        assert(spread.peek(key) == clustered.peek(key));
+    }
+    std::cout << "LFUCache index checks passed\n\n";
 }
 
 void test_mergeSort() {
@@ -365,11 +676,2680 @@ void test_mergeSort() {
     std::cout << "\n\n";
 }
 
+void test_sortRange() {
+    FreeList<int> freeList{9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+
+    // Sort only the middle of the list: [7 .. 2] -> [2 .. 7]
+    auto first = std::next(freeList.cbegin(), 2);
+    auto last = std::next(freeList.cbegin(), 8);
+    freeList.sort(first, last);
+
+    const std::vector<int> expected{9, 8, 2, 3, 4, 5, 6, 7, 1, 0};
+    assert(std::equal(freeList.begin(), freeList.end(), expected.begin(), expected.end()));
+    assert(std::equal(freeList.rbegin(), freeList.rend(), expected.rbegin(), expected.rend()));
+
+    // Sorting a suffix must update the tail
+    freeList.sort(std::next(freeList.cbegin(), 8), freeList.cend());
+    assert(freeList.back() == 1);
+
+    // Sorting a prefix must update the head
+    freeList.sort(freeList.cbegin(), std::next(freeList.cbegin(), 2));
+    assert(freeList.front() == 8);
+
+    // Default-constructed iterators stand for begin() and end()
+    FreeList<int> defaults{5, 4, 3, 2, 1, 0};
+    defaults.sort(std::next(defaults.cbegin(), 3));
+    defaults.sort(FreeList<int>::const_iterator(), std::next(defaults.cbegin(), 3));
+    const std::vector<int> halves{3, 4, 5, 0, 1, 2};
+    assert(std::equal(defaults.begin(), defaults.end(), halves.begin(), halves.end()));
+    defaults.sort(FreeList<int>::const_iterator(), FreeList<int>::const_iterator(), std::greater<int>());
+    assert(std::is_sorted(defaults.rbegin(), defaults.rend()) && defaults.back() == 0);
+
+    // Stability: equal keys keep their insertion order
+    FreeList<std::pair<int,int>> pairs;
+    for (int i = 0; i < 1000; ++i) {
+        pairs.push_back(std::make_pair((i * 7919) % 10, i));
+    }
+
+    pairs.sort([](const auto& a, const auto& b) { return a.first < b.first; });
+
+    auto prev = pairs.begin();
+    for (auto it = std::next(pairs.begin()); it != pairs.end(); prev = it++) {
+        assert(prev->first < it->first || (prev->first == it->first && prev->second < it->second));
+    }
+
+    std::cout << "Range sort and stability checks passed\n\n";
+}
+
+template<typename Container>
+bool in_storage_order(Container& container) {
+    const auto* prev = &container.front();
+    for (auto it = std::next(container.begin()); it != container.end(); ++it) {
+        if (&*it < prev) return false;
+        prev = &*it;
+    }
+    return true;
+}
+
+void test_compact() {
+    std::mt19937 gen(7);
+    FreeList<int> freeList;
+    std::list<int> expected;
+
+    for (int i = 0; i < 1000; ++i) {
+        freeList.push_back(i);
+        expected.push_back(i);
+    }
+
+    // Churn so that list order no longer follows storage order
+    for (int i = 0; i < 5000; ++i) {
+        const size_t pos = gen() % expected.size();
+        auto it = std::next(freeList.begin(), pos);
+        auto expectedIt = std::next(expected.begin(), pos);
+
+        if (gen() % 2 == 0) {
+            freeList.erase(it);
+            expected.erase(expectedIt);
+        } else {
+            freeList.insert(it, i);
+            expected.insert(expectedIt, i);
+        }
+    }
+
+    assert(!in_storage_order(freeList));
+
+    // Incremental compaction keeps the free slots but reorders live nodes
+    const size_t capacityBefore = freeList.capacity();
+    size_t calls = 1;
+    while (!freeList.compact_step(16)) {
+        calls++;
+    }
+
+    assert(calls > 1);
+    assert(freeList.capacity() == capacityBefore);
+    assert(in_storage_order(freeList));
+    assert(std::equal(freeList.begin(), freeList.end(), expected.begin(), expected.end()));
+    assert(std::equal(freeList.rbegin(), freeList.rend(), expected.rbegin(), expected.rend()));
+
+    // Changing the list mid-pass restarts it. Erasing the node placed last
+    // and reusing its slot at the front must not resume from that slot.
+    freeList.reverse();
+    expected.reverse();
+    for (int i = 0; i < 10; ++i) {
+        assert(!freeList.compact_step(1));
+    }
+    freeList.erase(std::next(freeList.begin(), 9));
+    expected.erase(std::next(expected.begin(), 9));
+    freeList.push_front(-2);
+    expected.push_front(-2);
+    while (!freeList.compact_step(16)) {}
+    assert(in_storage_order(freeList));
+    assert(std::equal(freeList.begin(), freeList.end(), expected.begin(), expected.end()));
+
+    // Full compaction drops free slots and reports every relocation
+    freeList.erase(std::next(freeList.begin(), 3));
+    expected.erase(std::next(expected.begin(), 3));
+
+    size_t remapped = 0;
+    freeList.compact([&](auto, auto) { remapped++; });
+
+    assert(remapped == freeList.size());
+    assert(freeList.capacity() == freeList.size());
+    assert(in_storage_order(freeList));
+    assert(std::equal(freeList.begin(), freeList.end(), expected.begin(), expected.end()));
+
+    // Erased slots are gone, so new elements are appended to fresh storage
+    freeList.push_back(-1);
+    expected.push_back(-1);
+    assert(std::equal(freeList.begin(), freeList.end(), expected.begin(), expected.end()));
+
+    LFUCache cache(3);
+    cache.put(1,1);
+    cache.put(2,2);
+    cache.put(3,3);
+    cache.get(1);
+    cache.get(2);
+    cache.get(1);
+    cache.compact();
+
+    assert(cache.get(3) == 3);
+    cache.put(4,4);
+    assert(cache.get(3) == 3);
+    assert(cache.get(2) == -1);
+    assert(cache.get(4) == 4);
+    assert(cache.get(1) == 1);
+
+    std::cout << "Compaction checks passed\n\n";
+}
+
+void test_freeChain() {
+    // Slots 0..9 hold 0..9; slots 2, 7 and 4 are freed in that order
+    FreeList<int> freeList;
+    freeList.reserve(16);
+    std::vector<const int*> slots;
+    for (int i = 0; i < 10; ++i) {
+        slots.push_back(&freeList.emplace_back(i));
+    }
+
+    auto second = std::next(freeList.cbegin(), 2);
+    auto seventh = std::next(freeList.cbegin(), 7);
+    auto fourth = std::next(freeList.cbegin(), 4);
+    freeList.erase(second);
+    freeList.erase(seventh);
+    freeList.erase(fourth);
+
+    // Erasing a slot that is already free changes nothing
+    freeList.erase(seventh);
+    std::vector<int> expected{0, 1, 3, 5, 6, 8, 9};
+    assert(freeList.size() == 7);
+    assert(std::equal(freeList.begin(), freeList.end(), expected.begin(), expected.end()));
+    assert(std::equal(freeList.rbegin(), freeList.rend(), expected.rbegin(), expected.rend()));
+
+    // Freed slots are reused most recent first, each of them once, before
+    // storage grows
+    assert(&*freeList.insert(freeList.cend(), 10) == slots[4]);
+    assert(&*freeList.insert(freeList.cend(), 11) == slots[7]);
+    assert(&*freeList.insert(freeList.cend(), 12) == slots[2]);
+    const int* fresh = &*freeList.insert(freeList.cend(), 13);
+    assert(std::find(slots.begin(), slots.end(), fresh) == slots.end());
+    assert(freeList.size() == 11);
+
+    expected.insert(expected.end(), {10, 11, 12, 13});
+    assert(std::equal(freeList.begin(), freeList.end(), expected.begin(), expected.end()));
+    assert(std::equal(freeList.rbegin(), freeList.rend(), expected.rbegin(), expected.rend()));
+
+    std::cout << "Free chain checks passed\n\n";
+}
+
+void test_indexType() {
+    FreeList<int, uint32_t> freeList{5, 3, 9, 1, 7};
+    freeList.insert(std::next(freeList.cbegin(), 2), 4);
+    freeList.erase(freeList.begin());
+    freeList.sort();
+
+    const std::vector<int> expected{1, 3, 4, 7, 9};
+    assert(std::equal(freeList.begin(), freeList.end(), expected.begin(), expected.end()));
+    assert(std::equal(freeList.rbegin(), freeList.rend(), expected.rbegin(), expected.rend()));
+
+    // A uint8_t index reserves 255 as the sentinel, leaving 255 usable slots
+    FreeList<int, uint8_t> small;
+    assert(small.max_size() == 255);
+
+    for (int i = 0; i < 255; ++i) {
+        small.push_back(i);
+    }
+
+    bool threw = false;
+    try {
+        small.push_back(255);
+    } catch (const std::length_error&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(small.size() == 255);
+
+    // Freed slots can still be reused once the index range is exhausted
+    small.pop_front();
+    small.push_back(255);
+    assert(small.size() == 255 && small.back() == 255 && small.front() == 1);
+
+    std::cout << "Index type checks passed\n\n";
+}
+
+void test_splitStorage() {
+    FreeList<std::string, uint32_t, SplitStorage> freeList{"delta", "alpha", "echo", "charlie"};
+    freeList.insert(std::next(freeList.cbegin()), "bravo");
+    freeList.erase(std::prev(freeList.end()));
+    freeList.push_front("foxtrot");
+    freeList.sort();
+
+    const std::vector<std::string> expected{"alpha", "bravo", "delta", "echo", "foxtrot"};
+    assert(std::equal(freeList.begin(), freeList.end(), expected.begin(), expected.end()));
+
+    freeList.compact();
+    assert(freeList.capacity() == freeList.size());
+    assert(in_storage_order(freeList));
+    assert(std::equal(freeList.rbegin(), freeList.rend(), expected.rbegin(), expected.rend()));
+
+    std::cout << "Split storage checks passed\n\n";
+}
+
+void test_chunkedStorage() {
+    FreeList<int, uint32_t, ChunkedStorage<4>> freeList;
+
+    freeList.push_back(0);
+    const int* first = &freeList.front();
+
+    for (int i = 1; i < 1000; ++i) {
+        freeList.push_back(i);
+    }
+
+    // Growth allocates new chunks without moving existing elements
+    assert(first == &freeList.front());
+    assert(freeList.capacity() == 1008);
+
+    freeList.erase(std::next(freeList.begin(), 10), std::next(freeList.begin(), 500));
+    freeList.insert(std::next(freeList.cbegin(), 10), {-3, -2, -1});
+    freeList.sort(std::greater<int>());
+
+    FreeList<int, uint32_t, ChunkedStorage<4>> copy = freeList;
+    assert(copy.size() == 513);
+    assert(std::equal(copy.begin(), copy.end(), freeList.begin(), freeList.end()));
+    assert(std::is_sorted(copy.begin(), copy.end(), std::greater<int>()));
+    assert(copy.back() == -3);
+
+    copy.compact();
+    assert(copy.capacity() == 528);
+    assert(std::equal(copy.rbegin(), copy.rend(), freeList.rbegin(), freeList.rend()));
+
+    // clear() keeps the chunks for reuse; shrink_to_fit() releases them
+    copy.clear();
+    assert(copy.empty() && copy.capacity() == 528);
+    copy.push_back(7);
+    assert(copy.front() == 7 && copy.capacity() == 528);
+    copy.clear();
+    copy.shrink_to_fit();
+    assert(copy.capacity() == 0);
+
+    std::cout << "Chunked storage checks passed\n\n";
+}
+
+struct Tracked {
+    static int alive;
+    int value;
+
+    explicit Tracked(int v) : value(v) { alive++; }
+    Tracked(const Tracked& other) : value(other.value) { alive++; }
+    Tracked(Tracked&& other) noexcept : value(other.value) { alive++; }
+    Tracked& operator=(const Tracked&) = default;
+    Tracked& operator=(Tracked&&) = default;
+    ~Tracked() { alive--; }
+};
+
+int Tracked::alive = 0;
+
+template<typename Storage>
+void check_payload_lifetime() {
+    {
+        // Tracked has no default constructor
+        FreeList<Tracked, uint32_t, Storage> freeList;
+
+        for (int i = 0; i < 100; ++i) {
+            freeList.push_back(Tracked(i));
+        }
+        assert(Tracked::alive == 100);
+
+        // Erased payloads are destroyed immediately, not when the slot is reused
+        freeList.erase(std::next(freeList.begin(), 10), std::next(freeList.begin(), 60));
+        freeList.pop_front();
+        assert(Tracked::alive == 49);
+
+        FreeList<Tracked, uint32_t, Storage> copy = freeList;
+        assert(Tracked::alive == 98);
+
+        copy.clear();
+        assert(Tracked::alive == 49);
+
+        freeList.push_back(Tracked(-1));
+        freeList.compact();
+        assert(Tracked::alive == 50);
+        assert(freeList.back().value == -1 && freeList.front().value == 1);
+    }
+    assert(Tracked::alive == 0);
+
+    // Move-only payloads
+    FreeList<std::unique_ptr<int>, uint32_t, Storage> owners;
+    for (int i = 0; i < 100; ++i) {
+        owners.push_back(std::make_unique<int>(i));
+    }
+    owners.erase(owners.begin());
+    owners.push_front(std::make_unique<int>(-1));
+    assert(*owners.front() == -1 && *owners.back() == 99);
+}
+
+void test_payloadLifetime() {
+    check_payload_lifetime<InterleavedStorage>();
+    check_payload_lifetime<SplitStorage>();
+    check_payload_lifetime<ChunkedStorage<4>>();
+
+    std::cout << "Payload lifetime checks passed\n\n";
+}
+
+struct Counted {
+    static int constructions;
+    static int copies;
+    static int moves;
+
+    std::string name;
+    int id;
+
+    Counted(std::string n, int i) : name(std::move(n)), id(i) { constructions++; }
+    Counted(const Counted& other) : name(other.name), id(other.id) { copies++; }
+    Counted(Counted&& other) noexcept : name(std::move(other.name)), id(other.id) { moves++; }
+    Counted& operator=(const Counted&) = delete;
+    Counted& operator=(Counted&&) = delete;
+
+    static void reset() {
+        constructions = copies = moves = 0;
+    }
+
+    static bool counts(int c, int cp, int mv) {
+        return constructions == c && copies == cp && moves == mv;
+    }
+};
+
+int Counted::constructions = 0;
+int Counted::copies = 0;
+int Counted::moves = 0;
+
+void test_emplace() {
+    FreeList<Counted> freeList;
+    freeList.reserve(16);
+
+    Counted::reset();
+    freeList.emplace_back("back", 1);
+    freeList.emplace_front("front", 0);
+    freeList.emplace(std::next(freeList.cbegin()), "middle", 2);
+    freeList.emplace(freeList.cend(), "end", 3);
+    assert(Counted::counts(4, 0, 0));
+
+    // Reusing a freed slot constructs in place as well
+    freeList.erase(std::next(freeList.begin()));
+    Counted::reset();
+    freeList.emplace(std::next(freeList.cbegin()), "reused", 4);
+    assert(Counted::counts(1, 0, 0));
+
+    Counted lvalue("lvalue", 5);
+    Counted::reset();
+    freeList.push_back(lvalue);
+    freeList.insert(freeList.cbegin(), lvalue);
+    assert(Counted::counts(0, 2, 0));
+    assert(lvalue.name == "lvalue");
+
+    Counted::reset();
+    freeList.push_front(Counted("rvalue", 6));
+    assert(Counted::counts(1, 0, 1));
+
+    const std::vector<int> ids{6, 5, 0, 4, 1, 3, 5};
+    assert(std::equal(freeList.begin(), freeList.end(), ids.begin(), ids.end(),
+                      [](const Counted& c, int id) { return c.id == id; }));
+
+    // Range insertion keeps the order of the source range
+    FreeList<int> ints{1, 5};
+    const std::vector<int> middle{2, 3, 4};
+    auto it = ints.insert(std::next(ints.cbegin()), middle.begin(), middle.end());
+    const std::vector<int> expected{1, 2, 3, 4, 5};
+    assert(*it == 2);
+    assert(std::equal(ints.begin(), ints.end(), expected.begin(), expected.end()));
+
+    std::cout << "Emplace checks passed\n\n";
+}
+
+template<typename Container>
+std::vector<int> ids_of(const Container& container) {
+    std::vector<int> ids;
+    for (const auto& c : container) {
+        ids.push_back(c.id);
+    }
+
+    // Walking backwards must agree with walking forwards
+    std::vector<int> reversed;
+    for (auto it = container.rbegin(); it != container.rend(); ++it) {
+        reversed.push_back(it->id);
+    }
+    assert(std::equal(ids.rbegin(), ids.rend(), reversed.begin(), reversed.end()));
+
+    return ids;
+}
+
+void test_listOperations() {
+    FreeList<Counted> freeList;
+    for (int i = 0; i < 6; ++i) {
+        freeList.emplace_back("node", i);
+    }
+
+    // Reordering within one list only rewrites links
+    Counted::reset();
+
+    freeList.reverse();
+    assert((ids_of(freeList) == std::vector<int>{5, 4, 3, 2, 1, 0}));
+
+    auto oldFirst = freeList.rotate(std::next(freeList.cbegin(), 2));
+    assert(oldFirst->id == 5);
+    assert((ids_of(freeList) == std::vector<int>{3, 2, 1, 0, 5, 4}));
+
+    freeList.splice(freeList.cbegin(), freeList, std::next(freeList.cbegin(), 3), freeList.cend());
+    assert((ids_of(freeList) == std::vector<int>{0, 5, 4, 3, 2, 1}));
+
+    freeList.splice(freeList.cend(), freeList, freeList.cbegin());
+    assert((ids_of(freeList) == std::vector<int>{5, 4, 3, 2, 1, 0}));
+
+    assert(Counted::counts(0, 0, 0));
+
+    // Across lists payloads are moved, never copied
+    FreeList<Counted> other;
+    other.emplace_back("other", 10);
+    other.emplace_back("other", 11);
+    other.emplace_back("other", 12);
+
+    Counted::reset();
+    freeList.splice(std::next(freeList.cbegin()), other, std::next(other.cbegin()), other.cend());
+    assert(Counted::counts(0, 0, 2));
+    assert((ids_of(freeList) == std::vector<int>{5, 11, 12, 4, 3, 2, 1, 0}));
+    assert((ids_of(other) == std::vector<int>{10}));
+
+    freeList.splice(freeList.cend(), other);
+    assert(other.empty() && other.size() == 0);
+    assert(freeList.size() == 9 && freeList.back().id == 10);
+
+    assert(freeList.remove_if([](const Counted& c) { return c.id >= 10; }) == 3);
+    assert((ids_of(freeList) == std::vector<int>{5, 4, 3, 2, 1, 0}));
+
+    // merge keeps both lists' order and favours this list on ties
+    FreeList<std::pair<int,int>> left{{1,0}, {3,0}, {5,0}, {5,1}};
+    FreeList<std::pair<int,int>> right{{0,1}, {3,1}, {5,2}, {9,1}};
+    left.merge(right, [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    const std::vector<std::pair<int,int>> merged{{0,1}, {1,0}, {3,0}, {3,1}, {5,0}, {5,1}, {5,2}, {9,1}};
+    assert(right.empty());
+    assert(std::equal(left.begin(), left.end(), merged.begin(), merged.end()));
+    assert(std::equal(left.rbegin(), left.rend(), merged.rbegin(), merged.rend()));
+    assert(left.back().first == 9);
+
+    FreeList<int> runs{1, 2, 2, 1, 1, 1, 3, 3, 4, 3};
+    assert(runs.unique() == 4);
+
+    const std::vector<int> uniqueRuns{1, 2, 1, 3, 4, 3};
+    assert(std::equal(runs.begin(), runs.end(), uniqueRuns.begin(), uniqueRuns.end()));
+    assert(std::equal(runs.rbegin(), runs.rend(), uniqueRuns.rbegin(), uniqueRuns.rend()));
+
+    std::cout << "List operation checks passed\n\n";
+}
+
+void test_rangeErase() {
+    {
+        FreeList<Tracked> freeList;
+        for (int i = 0; i < 100; ++i) {
+            freeList.emplace_back(i);
+        }
+
+        // Trim the tail, then a block out of the middle
+        auto it = freeList.erase(std::next(freeList.begin(), 80), freeList.end());
+        assert(it == freeList.end());
+        assert(freeList.size() == 80 && freeList.back().value == 79);
+
+        it = freeList.erase(std::next(freeList.begin(), 10), std::next(freeList.begin(), 30));
+        assert(it->value == 30);
+        assert(freeList.size() == 60 && Tracked::alive == 60);
+
+        // Freed slots are reused before the storage grows
+        const size_t capacity = freeList.capacity();
+        for (int i = 0; i < 40; ++i) {
+            freeList.emplace_front(-i);
+        }
+        assert(freeList.capacity() == capacity);
+
+        assert(erase_if(freeList, [](const Tracked& t) { return t.value % 2 != 0; }) == 50);
+        assert(freeList.size() == 50 && Tracked::alive == 50);
+        assert(std::all_of(freeList.begin(), freeList.end(), [](const Tracked& t) { return t.value % 2 == 0; }));
+
+        freeList.erase(freeList.begin(), freeList.end());
+        assert(freeList.empty() && freeList.size() == 0 && Tracked::alive == 0);
+    }
+    assert(Tracked::alive == 0);
+
+    std::cout << "Range erase checks passed\n\n";
+}
+
+void test_bulkInsert() {
+    FreeList<int> freeList(5, 7);
+    assert(freeList.size() == 5 && std::all_of(freeList.begin(), freeList.end(), [](int x) { return x == 7; }));
+
+    // Free some slots so the bulk path has to mix reused and fresh slots
+    freeList.erase(std::next(freeList.begin()), std::next(freeList.begin(), 3));
+
+    std::vector<int> batch(10);
+    std::iota(batch.begin(), batch.end(), 0);
+
+    auto it = freeList.insert(std::next(freeList.cbegin()), batch.begin(), batch.end());
+    assert(*it == 0);
+
+    std::vector<int> expected{7, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 7, 7};
+    assert(std::equal(freeList.begin(), freeList.end(), expected.begin(), expected.end()));
+    assert(std::equal(freeList.rbegin(), freeList.rend(), expected.rbegin(), expected.rend()));
+
+    it = freeList.insert(freeList.cend(), 3, -1);
+    assert(*it == -1 && freeList.size() == 16);
+
+    // Empty ranges insert nothing and return pos
+    it = freeList.insert(freeList.cbegin(), batch.end(), batch.end());
+    assert(it == freeList.begin() && freeList.size() == 16);
+
+    // allocate_n hands out a pre-linked run to fill in place
+    FreeList<int, uint32_t, SplitStorage> records;
+    records.push_back(100);
+
+    auto run = records.allocate_n(records.cbegin(), 4);
+    for (int i = 0; i < 4; ++i, ++run) {
+        assert(*run == 0);
+        *run = i + 1;
+    }
+    assert(run == std::prev(records.end()));
+
+    expected = {1, 2, 3, 4, 100};
+    assert(std::equal(records.begin(), records.end(), expected.begin(), expected.end()));
+
+    // Single-pass ranges still work
+    std::istringstream input("5 6 7");
+    records.insert(records.cend(), std::istream_iterator<int>(input), std::istream_iterator<int>());
+    assert(records.size() == 8 && records.back() == 7);
+
+    // std::vector<bool> iterators yield proxies by value
+    std::vector<bool> flags{true, false, false, true};
+    FreeList<bool> bits;
+    bits.insert(bits.cend(), flags.begin(), flags.end());
+    assert(std::equal(bits.begin(), bits.end(), flags.begin(), flags.end()));
+
+    std::cout << "Bulk insert checks passed\n\n";
+}
+
+template<typename SlotPolicy>
+void check_slot_policy_churn() {
+    std::mt19937 gen(7);
+    std::list<int> reference;
+    FreeList<int, uint32_t, InterleavedStorage, SlotPolicy> freeList;
+
+    for (int i = 0; i < 2000; ++i) {
+        const size_t pos = gen() % (reference.size() + 1);
+        const size_t op = gen() % 4;
+
+        if (op == 0 && !reference.empty()) {
+            const size_t len = std::min<size_t>(gen() % 8, reference.size() - std::min(pos, reference.size()));
+            reference.erase(std::next(reference.begin(), pos), std::next(reference.begin(), pos + len));
+            freeList.erase(std::next(freeList.begin(), pos), std::next(freeList.begin(), pos + len));
+        } else if (op == 1) {
+            const std::vector<int> batch{i, i + 1, i + 2};
+            reference.insert(std::next(reference.begin(), pos), batch.begin(), batch.end());
+            freeList.insert(std::next(freeList.cbegin(), pos), batch.begin(), batch.end());
+        } else {
+            reference.insert(std::next(reference.begin(), pos), i);
+            freeList.insert(std::next(freeList.cbegin(), pos), i);
+        }
+
+        assert(freeList.size() == reference.size());
+    }
+
+    assert(std::equal(freeList.begin(), freeList.end(), reference.begin(), reference.end()));
+    assert(std::equal(freeList.rbegin(), freeList.rend(), reference.rbegin(), reference.rend()));
+
+    // No free slots survive compact(), and none are left behind by clear()
+    freeList.compact();
+    freeList.push_back(-1);
+    reference.push_back(-1);
+    assert(std::equal(freeList.begin(), freeList.end(), reference.begin(), reference.end()));
+
+    freeList.clear();
+    freeList.push_back(1);
+    assert(freeList.size() == 1 && freeList.front() == 1);
+}
+
+void test_slotPolicies() {
+    // Slots 0..9 hold 0..9; free slots 2 and then 5
+    auto build = [](auto& freeList) {
+        for (int i = 0; i < 10; ++i) {
+            freeList.push_back(i);
+        }
+        std::vector<const int*> slots;
+        for (const int& x : freeList) {
+            slots.push_back(&x);
+        }
+        freeList.erase(std::next(freeList.begin(), 2));
+        freeList.erase(std::next(freeList.begin(), 4));
+        return slots;
+    };
+
+    {
+        FreeList<int, uint32_t, InterleavedStorage, LifoSlots> freeList;
+        auto slots = build(freeList);
+        freeList.push_back(10);
+        assert(&freeList.back() == slots[5]);
+    }
+
+    {
+        FreeList<int, uint32_t, InterleavedStorage, LowestFirstSlots> freeList;
+        auto slots = build(freeList);
+        freeList.push_back(10);
+        assert(&freeList.back() == slots[2]);
+    }
+
+    {
+        // A node lands in the free slot closest to its list neighbour
+        FreeList<int, uint32_t, InterleavedStorage, NearestSlots> freeList;
+        auto slots = build(freeList);
+        auto it = freeList.insert(std::next(freeList.cbegin(), 4), 10);
+        assert(*std::next(it) == 6 && &*it == slots[5]);
+        it = freeList.insert(freeList.cbegin(), 11);
+        assert(&*it == slots[2]);
+    }
+
+    check_slot_policy_churn<LifoSlots>();
+    check_slot_policy_churn<LowestFirstSlots>();
+    check_slot_policy_churn<NearestSlots>();
+
+    std::cout << "Slot policy checks passed\n\n";
+}
+
+void test_prefetchTraversal() {
+    FreeList<int, uint32_t, SplitStorage> freeList;
+
+    // Visiting an empty list calls nothing
+    freeList.for_each_prefetch([](int) { assert(false); });
+    for (int& x : freeList.prefetched()) {
+        (void)x;
+        assert(false);
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        freeList.push_back(i);
+    }
+    // Scatter list order across storage
+    freeList.sort([](int a, int b) { return (a * 37) % 100 < (b * 37) % 100; });
+
+    std::vector<int> expected(freeList.begin(), freeList.end());
+
+    std::vector<int> visited;
+    freeList.for_each([&visited](int x) { visited.push_back(x); });
+    assert(visited == expected);
+
+    for (const size_t distance : {0ul, 1ul, 3ul, 8ul, 99ul, 100ul, 1000ul}) {
+        visited.clear();
+        freeList.for_each_prefetch([&visited](int x) { visited.push_back(x); }, distance);
+        assert(visited == expected);
+
+        visited.clear();
+        for (int x : freeList.prefetched(distance)) {
+            visited.push_back(x);
+        }
+        assert(visited == expected);
+    }
+
+    // Payloads are handed out by reference and the functor is returned
+    auto counter = freeList.for_each([n = 0](int& x) mutable { x = n++; });
+    assert(std::is_sorted(freeList.begin(), freeList.end()));
+    (void)counter;
+
+    for (int& x : freeList.prefetched(4)) {
+        x *= 2;
+    }
+    assert(freeList.front() == 0 && freeList.back() == 198);
+
+    std::cout << "Prefetching traversal checks passed\n\n";
+}
+
+template<typename Storage>
+void check_unordered_scans() {
+    FreeList<int, uint32_t, Storage> freeList;
+
+    assert(freeList.find_unordered(1) == freeList.end());
+    assert(freeList.count_if_unordered([](int) { return true; }) == 0);
+    assert(freeList.sum() == 0);
+
+    // Enough elements for fully live bitmap words as well as partial ones
+    for (int i = 0; i < 1000; ++i) {
+        freeList.push_back(i);
+    }
+    freeList.remove_if([](int x) { return x % 3 == 0; });
+    freeList.erase(std::next(freeList.begin(), 100), std::next(freeList.begin(), 300));
+    freeList.push_front(-5);
+    freeList.insert(freeList.cend(), 3, 2000);
+
+    std::vector<int> expected(freeList.begin(), freeList.end());
+    std::vector<int> visited;
+    freeList.for_each_unordered([&visited](int x) { visited.push_back(x); });
+    std::sort(expected.begin(), expected.end());
+    std::sort(visited.begin(), visited.end());
+    assert(visited == expected);
+
+    assert(freeList.min() == -5 && freeList.max() == 2000);
+    assert(freeList.sum() == std::accumulate(expected.begin(), expected.end(), 0));
+    assert(freeList.count_if_unordered([](int x) { return x % 2 == 0; }) ==
+           static_cast<size_t>(std::count_if(expected.begin(), expected.end(), [](int x) { return x % 2 == 0; })));
+
+    auto it = freeList.find_unordered(998);
+    assert(it != freeList.end() && *it == 998);
+    assert(freeList.find_unordered(3) == freeList.end());
+    assert(freeList.find_unordered(150) == freeList.end());
+
+    // Elements can be modified through the unordered visit
+    freeList.for_each_unordered([](int& x) { x = -x; });
+    assert(freeList.min() == -2000 && freeList.max() == 5);
+
+    freeList.compact();
+    assert(freeList.count_if_unordered([](int) { return true; }) == freeList.size());
+    assert(*freeList.find_unordered(5) == 5);
+
+    freeList.clear();
+    assert(freeList.find_unordered(5) == freeList.end());
+}
+
+void test_unorderedScans() {
+    check_unordered_scans<InterleavedStorage>();
+    check_unordered_scans<SplitStorage>();
+    check_unordered_scans<ChunkedStorage<4>>();
+
+    // Non-arithmetic payloads reduce through operator< and operator+
+    FreeList<std::string> words{"pear", "apple", "fig"};
+    assert(words.min() == "apple" && words.max() == "pear");
+    assert(words.sum().size() == 12);
+
+    std::cout << "Unordered scan checks passed\n\n";
+}
+
+struct Keyed {
+    int key;
+    int seq;
+};
+
+#ifdef FREELIST_PARALLEL_SORT
+template<typename Policy, typename Container>
+void check_parallel_sort(Policy&& policy, Container& freeList, const std::vector<Keyed>& input) {
+    auto byKey = [](const Keyed& a, const Keyed& b) { return a.key < b.key; };
+    std::vector<Keyed> expected(input);
+    std::stable_sort(expected.begin(), expected.end(), byKey);
+
+    freeList.clear();
+    freeList.insert(freeList.cend(), input.begin(), input.end());
+    freeList.sort(policy, byKey);
+
+    // Equal keys keep their original relative order
+    assert(std::equal(freeList.begin(), freeList.end(), expected.begin(), expected.end(),
+                      [](const Keyed& a, const Keyed& b) { return a.key == b.key && a.seq == b.seq; }));
+    assert(std::equal(freeList.rbegin(), freeList.rend(), expected.rbegin(), expected.rend(),
+                      [](const Keyed& a, const Keyed& b) { return a.seq == b.seq; }));
+}
+
+void test_parallelSort() {
+    std::mt19937 gen(11);
+    std::vector<Keyed> input;
+    for (int i = 0; i < 200000; ++i) {
+        input.push_back({static_cast<int>(gen() % 1000), i});
+    }
+
+    FreeList<Keyed, uint32_t> freeList;
+    check_parallel_sort(std::execution::par, freeList, input);
+    check_parallel_sort(std::execution::seq, freeList, input);
+    check_parallel_sort(std::execution::par_unseq, freeList, input);
+
+    // Short lists take the sequential merge sort
+    std::vector<Keyed> small(input.begin(), input.begin() + 1000);
+    check_parallel_sort(std::execution::par, freeList, small);
+
+    // Payloads that are not copied into the buffer are sorted by index
+    FreeList<std::string> words;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 100000; ++i) {
+        std::string word = std::to_string(gen() % 50000);
+        words.push_back(word);
+        expected.push_back(word);
+    }
+    std::sort(expected.begin(), expected.end(), std::greater<std::string>());
+
+    words.sort(std::execution::par, std::greater<std::string>());
+    assert(std::equal(words.begin(), words.end(), expected.begin(), expected.end()));
+
+    // Compacting leaves the sorted list laid out in storage order
+    FreeList<int> numbers;
+    for (int i = 0; i < 100000; ++i) {
+        numbers.push_back(static_cast<int>(gen()));
+    }
+    numbers.erase(numbers.begin(), std::next(numbers.begin(), 1000));
+    numbers.sort(std::execution::par, std::less<int>(), true);
+    assert(std::is_sorted(numbers.begin(), numbers.end()));
+    assert(numbers.size() == 99000 && numbers.capacity() == numbers.size());
+    assert(in_storage_order(numbers));
+
+    std::cout << "Parallel sort checks passed\n\n";
+}
+#endif
+
+template<typename Value>
+void check_radix_sort(const std::vector<Value>& input) {
+    FreeList<Value, uint32_t> freeList;
+    freeList.insert(freeList.cend(), input.begin(), input.end());
+    std::vector<Value> expected(input);
+
+    std::sort(expected.begin(), expected.end());
+    freeList.sort();
+    assert(std::equal(freeList.begin(), freeList.end(), expected.begin(), expected.end()));
+    assert(std::equal(freeList.rbegin(), freeList.rend(), expected.rbegin(), expected.rend()));
+
+    std::sort(expected.begin(), expected.end(), std::greater<Value>());
+    freeList.sort(std::greater<>());
+    assert(std::equal(freeList.begin(), freeList.end(), expected.begin(), expected.end()));
+}
+
+void test_radixSort() {
+    std::mt19937_64 gen(5);
+
+    std::vector<int> ints;
+    for (int i = 0; i < 5000; ++i) {
+        ints.push_back(static_cast<int>(gen()));
+    }
+    ints.push_back(std::numeric_limits<int>::min());
+    ints.push_back(std::numeric_limits<int>::max());
+    ints.push_back(0);
+    check_radix_sort(ints);
+
+    std::vector<int64_t> wide;
+    std::vector<uint8_t> bytes;
+    std::vector<bool> flags;
+    for (int i = 0; i < 1000; ++i) {
+        wide.push_back(static_cast<int64_t>(gen()) >> (gen() % 64));
+        bytes.push_back(static_cast<uint8_t>(gen()));
+        flags.push_back(gen() % 2 == 0);
+    }
+    check_radix_sort(wide);
+    check_radix_sort(bytes);
+    check_radix_sort(std::vector<char>{'q', 'a', 'z'});
+    check_radix_sort(std::vector<bool>(flags.begin(), flags.end()));
+
+    // Sorting by an extracted key is stable
+    std::vector<Keyed> records;
+    for (int i = 0; i < 3000; ++i) {
+        records.push_back({static_cast<int>(gen() % 100) - 50, i});
+    }
+    FreeList<Keyed> freeList;
+    freeList.insert(freeList.cend(), records.begin(), records.end());
+    freeList.erase(std::next(freeList.begin(), 10), std::next(freeList.begin(), 20));
+    records.erase(records.begin() + 10, records.begin() + 20);
+
+    freeList.radix_sort([](const Keyed& k) { return k.key; });
+    std::stable_sort(records.begin(), records.end(), [](const Keyed& a, const Keyed& b) { return a.key < b.key; });
+    assert(std::equal(freeList.begin(), freeList.end(), records.begin(), records.end(),
+                      [](const Keyed& a, const Keyed& b) { return a.key == b.key && a.seq == b.seq; }));
+
+    FreeList<Keyed> empty;
+    empty.radix_sort([](const Keyed& k) { return k.key; });
+    assert(empty.empty());
+
+    std::cout << "Radix sort checks passed\n\n";
+}
+
+void test_handles() {
+    using List = FreeList<std::string, uint32_t>;
+    static_assert(sizeof(List::Handle) == 8, "32-bit indices give 8-byte handles");
+
+    List freeList{"a", "b", "c", "d"};
+    auto b = freeList.handle(std::next(freeList.cbegin()));
+    auto c = freeList.handle(std::next(freeList.cbegin(), 2));
+
+    assert(freeList.contains(b) && *freeList.get(b) == "b");
+    assert(freeList.iterator_to(c) == std::next(freeList.begin(), 2));
+
+    // The freed slot is reused, but the old handle does not alias the newcomer
+    assert(freeList.erase(b));
+    assert(!freeList.contains(b) && freeList.get(b) == nullptr);
+    assert(!freeList.erase(b));
+    assert(freeList.iterator_to(b) == freeList.end());
+
+    auto e = freeList.handle(freeList.insert(freeList.cend(), "e"));
+    assert(e.index == b.index && e != b);
+    assert(*freeList.get(e) == "e" && freeList.get(b) == nullptr);
+
+    // Relinking keeps handles valid
+    freeList.sort(std::greater<std::string>());
+    freeList.reverse();
+    assert(*freeList.get(c) == "c" && *freeList.get(e) == "e");
+
+    // Moving nodes between slots invalidates handles; the remap reports
+    // where each element went
+    std::unordered_map<std::string, List::Handle> handles;
+    for (auto it = freeList.cbegin(); it != freeList.cend(); ++it) {
+        handles[*it] = freeList.handle(it);
+    }
+    while (!freeList.compact_step(1, [&](List::const_iterator, List::iterator to) {
+        assert(!freeList.contains(handles[*to]));
+        handles[*to] = freeList.handle(to);
+    })) {}
+    for (const auto& entry : handles) {
+        assert(*freeList.get(entry.second) == entry.first);
+    }
+
+    auto first = freeList.handle(freeList.cbegin());
+    freeList.erase(std::next(freeList.begin()));
+    freeList.compact();
+    assert(!freeList.contains(first));
+    const List& constList = freeList;
+    assert(constList.get(freeList.handle(freeList.cbegin())) == &freeList.front());
+
+    auto last = freeList.handle(std::prev(freeList.cend()));
+    freeList.clear();
+    freeList.push_back("f");
+    freeList.push_back("g");
+    freeList.push_back("h");
+    assert(!freeList.contains(last) && !freeList.contains(first) && !freeList.contains(c));
+
+    // Generations do not share a narrow index type's range: freeing one
+    // slot far more than 256 times never revives the first handle
+    FreeList<int, uint8_t> narrow{0};
+    auto original = narrow.handle(narrow.cbegin());
+    for (int i = 1; i <= 1000; ++i) {
+        narrow.pop_front();
+        narrow.push_back(i);
+        auto current = narrow.handle(narrow.cbegin());
+        assert(current.index == original.index && !narrow.contains(original));
+        if (i % 100 == 0) {
+            narrow.compact();
+        }
+    }
+    assert(*narrow.get(narrow.handle(narrow.cbegin())) == 1000);
+
+    std::cout << "Handle checks passed\n\n";
+}
+
+// Memory resource that counts its live allocations and can refuse to serve
+// any, to prove where a list's memory comes from.
+class CountingResource : public pmr::memory_resource {
+public:
+    size_t allocations = 0;
+    size_t live = 0;
+    size_t bytes = 0;
+    // Allocations past this many throw std::bad_alloc
+    size_t limit = std::numeric_limits<size_t>::max();
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (allocations == limit) {
+            throw std::bad_alloc();
+        }
+        allocations++;
+        live++;
+        this->bytes += bytes;
+        return pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        live--;
+        this->bytes -= bytes;
+        pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+template<typename Storage>
+void check_pmr_storage() {
+    CountingResource arena;
+    CountingResource other;
+    {
+        PmrFreeList<pmr::string, uint32_t, Storage, LowestFirstSlots> freeList(&arena);
+        for (int i = 0; i < 100; ++i) {
+            freeList.push_back(pmr::string(40, static_cast<char>('a' + i % 26)));
+        }
+        freeList.remove_if([](const pmr::string& s) { return s[0] == 'b'; });
+        freeList.compact();
+        assert(arena.allocations > 0 && freeList.get_allocator().resource() == &arena);
+
+        // Payloads are built with the list's allocator too
+        assert(freeList.front().get_allocator().resource() == &arena);
+
+        // Moving into another resource moves the elements across
+        PmrFreeList<pmr::string, uint32_t, Storage, LowestFirstSlots> moved(std::move(freeList), &other);
+        assert(moved.size() == 96 && freeList.empty() && moved.front() == pmr::string(40, 'a'));
+        assert(moved.front().get_allocator().resource() == &other);
+
+        // Move assignment between unequal resources keeps each list's own
+        freeList = std::move(moved);
+        assert(freeList.size() == 96 && freeList.get_allocator().resource() == &arena);
+        assert(freeList.back().get_allocator().resource() == &arena);
+
+        PmrFreeList<pmr::string, uint32_t, Storage, LowestFirstSlots> copy(freeList, &other);
+        assert(std::equal(copy.begin(), copy.end(), freeList.begin(), freeList.end()));
+
+        copy.swap(moved);
+        assert(copy.empty() && moved.size() == 96);
+    }
+    assert(arena.live == 0 && other.live == 0);
+}
+
+// Freeing a node never allocates, so erasing from a list whose resource
+// has run dry cannot stop halfway with the payload already destroyed
+template<typename SlotPolicy>
+void check_pmr_release() {
+    for (size_t limit = 0; limit < 40; ++limit) {
+        CountingResource limited;
+        limited.limit = limit;
+        {
+            PmrFreeList<Tracked, size_t, InterleavedStorage, SlotPolicy> freeList(&limited);
+            try {
+                for (int i = 0; i < 300; ++i) {
+                    freeList.emplace_back(i);
+                }
+            } catch (const std::bad_alloc&) {
+            }
+
+            limited.limit = limited.allocations;
+            size_t size = freeList.size();
+            if (size >= 3) {
+                freeList.pop_front();
+                freeList.pop_back();
+                freeList.erase(std::next(freeList.begin()));
+                size -= 3;
+            }
+            assert(freeList.size() == size && static_cast<size_t>(Tracked::alive) == size);
+            assert(static_cast<size_t>(std::distance(freeList.begin(), freeList.end())) == size);
+
+            freeList.clear();
+            assert(Tracked::alive == 0);
+        }
+        assert(limited.live == 0);
+    }
+}
+
+void test_allocators() {
+    check_pmr_storage<InterleavedStorage>();
+    check_pmr_storage<SplitStorage>();
+    check_pmr_storage<ChunkedStorage<4>>();
+    check_pmr_release<LowestFirstSlots>();
+    check_pmr_release<NearestSlots>();
+
+    // Nested lists pick up the outer list's resource
+    CountingResource arena;
+    {
+        PmrFreeList<PmrFreeList<int>> lists(&arena);
+        lists.emplace_back();
+        lists.emplace_back(PmrFreeList<int>{1, 2, 3});
+        for (int i = 0; i < 50; ++i) {
+            lists.front().push_back(i);
+        }
+
+        for (const auto& inner : lists) {
+            assert(inner.get_allocator().resource() == &arena);
+        }
+        assert(lists.back().size() == 3 && lists.front().size() == 50);
+    }
+    assert(arena.live == 0);
+
+    // Running out of memory at any point of growth, including the liveness
+    // bitmap and generation table, leaves no payload outside the list
+    for (size_t limit = 0; limit < 40; ++limit) {
+        CountingResource limited;
+        limited.limit = limit;
+        {
+            PmrFreeList<Tracked> freeList(&limited);
+            try {
+                for (int i = 0; i < 200; ++i) {
+                    freeList.emplace_back(i);
+                }
+                freeList.insert(freeList.cend(), 100, Tracked(-1));
+            } catch (const std::bad_alloc&) {
+            }
+            assert(static_cast<size_t>(Tracked::alive) == freeList.size());
+            assert(static_cast<size_t>(std::distance(freeList.begin(), freeList.end())) == freeList.size());
+        }
+        assert(Tracked::alive == 0 && limited.live == 0);
+    }
+
+    // The whole cache can live in an arena
+    std::vector<std::byte> buffer(1 << 20);
+    pmr::monotonic_buffer_resource monotonic(buffer.data(), buffer.size(), pmr::null_memory_resource());
+    LFUCache cache(64, &monotonic);
+    for (int i = 0; i < 1000; ++i) {
+        cache.put(i % 100, i);
+        cache.get((i * 7) % 100);
+    }
+    cache.compact();
+    // The last operation before the final get() stored 999 under key 99
+    assert(cache.get(99) == 999);
+
+    std::cout << "Allocator checks passed\n\n";
+}
+
+// Built, edited, sorted and read back entirely at compile time
+constexpr int inplace_digits() {
+    InplaceFreeList<int, 8> freeList{3, 1, 4};
+    freeList.push_front(1);
+    freeList.insert(std::next(freeList.cbegin(), 2), 5);
+    freeList.erase(freeList.find(4));
+    freeList.sort(std::greater<int>());
+
+    int digits = 0;
+    for (int value : freeList) {
+        digits = digits * 10 + value;
+    }
+    return digits;
+}
+
+void test_inplaceFreeList() {
+    static_assert(sizeof(InplaceFreeList<int, 16>::Index) == 1, "up to 254 slots use 8-bit links");
+    static_assert(sizeof(InplaceFreeList<int, 255>::Index) == 2, "255 slots need 16-bit links");
+    static_assert(sizeof(InplaceFreeList<int, 70000>::Index) == 4, "");
+    static_assert(inplace_digits() == 5311, "");
+
+    // Overflow is reported, never grown into
+    InplaceFreeList<int, 4> small{1, 2, 3};
+    assert(small.push_back(4) && small.full());
+    assert(!small.push_back(5) && !small.push_front(0));
+    assert(small.emplace_back(5) == nullptr && small.insert(small.cbegin(), 0) == small.end());
+    assert(small.size() == 4 && small.back() == 4);
+
+    // Range insertions are all-or-nothing
+    small.pop_front();
+    small.pop_front();
+    std::list<int> three{7, 8, 9};
+    assert(small.insert(small.cend(), three.begin(), three.end()) == small.end());
+    assert(small.insert(small.cend(), 3, 7) == small.end());
+    std::istringstream words("7 8 9");
+    assert(small.insert(small.cend(), std::istream_iterator<int>(words), std::istream_iterator<int>()) == small.end());
+    assert((std::vector<int>(small.begin(), small.end()) == std::vector<int>{3, 4}));
+    assert(*small.insert(small.cbegin(), {1, 2}) == 1 && small.full());
+    assert((InplaceFreeList<int, 2>(3, 1).empty()));
+
+    // Freed slots are reused, so churn never runs out of room
+    for (int i = 0; i < 100; ++i) {
+        small.erase(small.begin());
+        assert(*small.emplace_back(i) == i);
+    }
+    assert((std::vector<int>(small.rbegin(), small.rend()) == std::vector<int>{99, 98, 97, 96}));
+
+    // Non-trivial payloads are constructed and destroyed in place
+    {
+        InplaceFreeList<Tracked, 8> tracked;
+        for (int i = 0; i < 8; ++i) {
+            tracked.emplace_back(i);
+        }
+        assert(Tracked::alive == 8 && tracked.emplace_front(8) == nullptr && Tracked::alive == 8);
+        tracked.remove_if([](const Tracked& t) { return t.value % 2 == 0; });
+        assert(Tracked::alive == 4);
+
+        InplaceFreeList<Tracked, 8> copy(tracked);
+        tracked.sort([](const Tracked& a, const Tracked& b) { return a.value > b.value; });
+        assert(Tracked::alive == 8 && copy.front().value == 1 && tracked.front().value == 7);
+
+        InplaceFreeList<Tracked, 8> moved(std::move(copy));
+        assert(copy.empty() && moved.size() == 4 && Tracked::alive == 8);
+        moved.swap(tracked);
+        assert(moved.front().value == 7 && tracked.front().value == 1);
+    }
+    assert(Tracked::alive == 0);
+
+    InplaceFreeList<std::string, 6> names{"b", "a", "c"};
+    InplaceFreeList<std::string, 6> more{"a", "d"};
+    InplaceFreeList<std::string, 6> tooMany{"a", "b", "c", "d"};
+    names.sort();
+    assert(!names.merge(tooMany) && tooMany.size() == 4);
+    assert(names.merge(more) && more.empty());
+    assert(names.unique() == 1 && erase_if(names, [](const std::string& s) { return s == "c"; }) == 1);
+    names.reverse();
+    assert((std::vector<std::string>(names.begin(), names.end()) == std::vector<std::string>{"d", "b", "a"}));
+
+    std::cout << "InplaceFreeList checks passed\n\n";
+}
+
+void test_smallFreeList() {
+    // Inline payloads move one by one, so moves and swaps are only noexcept
+    // when the payload's are
+    struct ThrowingMove {
+        ThrowingMove() = default;
+        ThrowingMove(ThrowingMove&&) {}
+        ThrowingMove& operator=(ThrowingMove&&) { return *this; }
+    };
+    static_assert(!std::is_nothrow_move_constructible<SmallFreeList<ThrowingMove, 4>>::value, "");
+    static_assert(!noexcept(std::declval<SmallFreeList<ThrowingMove, 4>&>().swap(
+                      std::declval<SmallFreeList<ThrowingMove, 4>&>())), "");
+    static_assert(std::is_nothrow_move_constructible<SmallFreeList<int, 4>>::value, "");
+    static_assert(std::is_nothrow_move_constructible<FreeList<ThrowingMove>>::value, "");
+
+    CountingResource resource;
+    {
+        using List = SmallFreeList<pmr::string, 4, uint32_t, LifoSlots, pmr::polymorphic_allocator<pmr::string>>;
+
+        // Up to four nodes, side tables included, never reach the resource
+        List small(&resource);
+        for (int i = 0; i < 4; ++i) {
+            small.push_back(pmr::string(1, static_cast<char>('a' + i)));
+        }
+        small.erase(small.begin());
+        small.push_front("z");
+        small.sort();
+        small.reverse();
+        assert(resource.allocations == 0 && small.capacity() == 4);
+
+        // Spilling keeps indices, iterators and inline addresses
+        auto second = std::next(small.begin());
+        const pmr::string* address = &*second;
+        for (int i = 0; i < 20; ++i) {
+            small.push_back(pmr::string(30, static_cast<char>('A' + i)));
+        }
+        assert(resource.allocations > 0 && small.size() == 24);
+        assert(&*second == address && *second == "d" && std::next(small.begin()) == second);
+        assert(small.get_allocator().resource() == &resource);
+
+        // Copies, moves and swaps between inline and spilled lists
+        List copy(small, &resource);
+        assert(std::equal(copy.begin(), copy.end(), small.begin(), small.end()));
+
+        List other({"x", "y"}, &resource);
+        other.swap(copy);
+        assert(copy.size() == 2 && copy.back() == "y" && other.size() == 24 && *std::next(other.begin()) == "d");
+
+        List moved(std::move(other));
+        assert(other.empty() && moved.size() == 24 && moved.front() == "z");
+        other = std::move(copy);
+        assert(copy.empty() && other.size() == 2 && other.front() == "x");
+
+        // Compaction and shrinking bring a small list back inline
+        moved.remove_if([](const pmr::string& s) { return s.size() > 1; });
+        moved.compact();
+        moved.shrink_to_fit();
+        assert(moved.capacity() == 4 && (std::vector<std::string>(moved.begin(), moved.end()) ==
+                                          std::vector<std::string>{"z", "d", "c", "b"}));
+    }
+    assert(resource.live == 0);
+
+    check_payload_lifetime<SmallStorage<3>>();
+
+    std::cout << "SmallFreeList checks passed\n\n";
+}
+
+void test_concurrentFreeList() {
+    {
+        ConcurrentFreeList<Tracked, 2> pool;
+        auto a = pool.emplace(1);
+        auto b = pool.emplace(2);
+        assert(pool[a].value == 1 && pool[b].value == 2 && pool.size() == 2);
+
+        // Freed slots are reused most recent first
+        pool.erase(a);
+        assert(pool.emplace(3) == a && pool[a].value == 3 && Tracked::alive == 2);
+
+        // Growing by whole segments never moves existing payloads
+        const Tracked* address = &pool[b];
+        std::vector<ConcurrentFreeList<Tracked, 2>::Index> more;
+        for (int i = 0; i < 1000; ++i) {
+            more.push_back(pool.emplace(i));
+        }
+        assert(&pool[b] == address && pool.capacity() >= 1002 && pool.size() == 1002);
+        for (size_t i = 0; i < more.size(); ++i) {
+            assert(pool[more[i]].value == static_cast<int>(i));
+        }
+    }
+    assert(Tracked::alive == 0);
+
+    // A segment that cannot be allocated costs no indices: once memory is
+    // available again, the pool carries on from the first unused slot
+    {
+        CountingResource limited;
+        limited.limit = 1;
+        ConcurrentFreeList<int, 2, pmr::polymorphic_allocator<int>> pool(&limited);
+        for (int i = 0; i < 4; ++i) {
+            assert(pool.emplace(i) == static_cast<uint32_t>(i));
+        }
+        bool threw = false;
+        try {
+            pool.emplace(4);
+        } catch (const std::bad_alloc&) {
+            threw = true;
+        }
+        assert(threw && pool.size() == 4 && pool.capacity() == 4);
+
+        limited.limit = 2;
+        assert(pool.emplace(4) == 4 && pool.emplace(5) == 5 && pool.size() == 6);
+    }
+
+    // Threads churn through shared slots; every slot must be owned by one
+    // thread at a time and the pool must end up empty
+    ConcurrentFreeList<std::pair<size_t, size_t>> pool;
+    const size_t threads = 4;
+    const size_t rounds = 20000;
+    std::atomic<size_t> conflicts(0);
+    std::vector<std::thread> workers;
+
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::vector<ConcurrentFreeList<std::pair<size_t, size_t>>::Index> held;
+            for (size_t round = 0; round < rounds; ++round) {
+                held.push_back(pool.emplace(t, round));
+                if (held.size() == 8 || round + 1 == rounds) {
+                    for (auto index : held) {
+                        conflicts += (pool[index].first != t);
+                        pool.erase(index);
+                    }
+                    held.clear();
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    assert(conflicts == 0 && pool.empty());
+    // At most threads * 8 slots were ever held at once, so one segment did
+    assert(pool.capacity() == 1024);
+
+    std::cout << "ConcurrentFreeList checks passed\n\n";
+}
+
+void test_magazines() {
+    using Pool = ConcurrentFreeList<std::pair<size_t, size_t>>;
+    Pool pool;
+    {
+        Pool::Magazine magazine(pool);
+        auto a = magazine.emplace(1, 1);
+        auto b = magazine.emplace(2, 2);
+        assert(magazine[a].first == 1 && pool[b].second == 2);
+
+        // Frees stay in the Magazine and are reused first
+        magazine.erase(a);
+        assert(magazine.emplace(3, 3) == a);
+
+        // Size changes reach the pool in batches, and fully on flush
+        magazine.erase(a);
+        magazine.erase(b);
+        magazine.flush();
+        assert(pool.empty());
+    }
+
+    // Consumers free slots that producers allocated; once every thread and
+    // its Magazine are gone, all slots are back in the pool and a second
+    // run needs no new ones
+    const size_t pairs = 2;
+    const size_t rounds = 5000;
+    std::atomic<size_t> mismatches(0);
+
+    auto run = [&] {
+        std::vector<std::vector<Pool::Index>> handoff(pairs);
+        std::vector<std::thread> producers;
+        for (size_t p = 0; p < pairs; ++p) {
+            producers.emplace_back([&, p] {
+                Pool::Magazine magazine(pool);
+                for (size_t round = 0; round < rounds; ++round) {
+                    handoff[p].push_back(magazine.emplace(p, round));
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+
+        std::vector<std::thread> consumers;
+        for (size_t p = 0; p < pairs; ++p) {
+            consumers.emplace_back([&, p] {
+                Pool::Magazine magazine(pool);
+                for (size_t round = 0; round < rounds; ++round) {
+                    auto index = handoff[p][round];
+                    mismatches += (pool[index] != std::make_pair(p, round));
+                    magazine.erase(index);
+                }
+            });
+        }
+        for (auto& consumer : consumers) {
+            consumer.join();
+        }
+    };
+
+    run();
+    size_t capacity = pool.capacity();
+    run();
+    assert(mismatches == 0 && pool.empty() && pool.capacity() == capacity);
+
+    std::cout << "Magazine checks passed\n\n";
+}
+
+void test_shardedLFUCache() {
+    // A single shard evicts exactly like LFUCache
+    ShardedLFUCache<int, std::string> single(2, 1);
+    single.put(1, "one");
+    single.put(2, "two");
+    assert(single.get(1) == std::string("one"));
+    single.put(3, "three");
+    assert(!single.get(2) && single.get(3) == std::string("three"));
+    single.put(5, "five");
+    assert(!single.get(1) && single.get(3) && single.get(5));
+
+    ShardedLFUCache<std::string, int> named(64, 5);
+    assert(named.shard_count() == 8);
+    named.put("a", 1);
+    named.put("a", 2);
+    assert(named.get("a") == 2 && !named.get("b"));
+
+    // Fewer slots than shards: the shard count drops until every shard
+    // has a slot, so each key can be read back right after it is put, and
+    // the shares still add up to the capacity
+    ShardedLFUCache<int, int> split(10, 16);
+    assert(split.shard_count() == 8);
+    for (int i = 0; i < 1000; ++i) {
+        split.put(i, i);
+        assert(split.get(i) == i);
+    }
+    int resident = 0;
+    for (int i = 0; i < 1000; ++i) {
+        resident += split.get(i).has_value();
+    }
+    assert(resident <= 10);
+
+    ShardedLFUCache<int, int> tiny(1, 64);
+    assert(tiny.shard_count() == 1);
+    tiny.put(1, 1);
+    tiny.put(2, 2);
+    assert(!tiny.get(1) && tiny.get(2) == 2);
+
+    ShardedLFUCache<int, int> none(-1, 4);
+    assert(none.shard_count() == 1);
+    none.put(1, 1);
+    assert(!none.get(1));
+
+    // Threads hammer overlapping key ranges; every value read back must be
+    // one that was written for that key
+    ShardedLFUCache<int, int> shared(256, 8);
+    std::atomic<size_t> wrong(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < 20000; ++i) {
+                int key = (i * 7 + t * 13) % 500;
+                if (auto value = shared.get(key)) {
+                    wrong += (*value % 1000 != key);
+                } else {
+                    shared.put(key, key + 1000 * t);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    assert(wrong == 0);
+
+    // Buffered hits count once applied: the batch runs before the write
+    // that needs an eviction, so the frequently read key survives it
+    ShardedLFUCache<int, int> buffered(2, 1, pmr::get_default_resource(), LFUHitPolicy::buffered);
+    buffered.put(1, 1);
+    buffered.put(2, 2);
+    for (int i = 0; i < 3; ++i) {
+        assert(buffered.get(1) == 1);
+    }
+    buffered.put(3, 3);
+    assert(buffered.get(1) == 1 && !buffered.get(2) && buffered.get(3) == 3);
+
+    // Far more reads than the buffer holds, from several threads at once
+    std::atomic<size_t> misses(0);
+    workers.clear();
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < 20000; ++i) {
+                if (i % 100 == 0) {
+                    buffered.put(4 + t, t);
+                }
+                misses += !buffered.get(1);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    assert(misses == 0);
+
+    std::cout << "ShardedLFUCache checks passed\n\n";
+}
+
+template<size_t Bytes>
+struct Payload {
+    int key;
+    char padding[Bytes - sizeof(int)];
+
+    Payload(int k = 0) : key(k), padding() {}
+
+    bool operator<(const Payload& other) const {
+        return key < other.key;
+    }
+};
+
+template<typename Container>
+double measure_sort(Container& container) {
+    auto start = std::chrono::high_resolution_clock::now();
+    container.sort();
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << "Sort time: " << duration.count() << " seconds\n";
+
+    return duration.count();
+}
+
+template<typename Container>
+double measure_traversal(Container& container) {
+    auto start = std::chrono::high_resolution_clock::now();
+    const auto hops = std::distance(container.begin(), container.end());
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << "Traversal time: " << duration.count() << " seconds (" << hops << " hops)\n";
+
+    return duration.count();
+}
+
+template<typename Value, typename Storage>
+double measure_storage(const char* name, size_t count) {
+    std::mt19937 gen(42);
+    FreeList<Value, uint32_t, Storage> freeList;
+    freeList.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        freeList.push_back(Value(static_cast<int>(gen())));
+    }
+
+    std::cout << name << " with " << sizeof(Value) << "-byte payloads\n";
+
+    // Sorting by a random key scatters list order across storage, so the
+    // traversal that follows is a pure link-chasing pass.
+    double total = measure_sort(freeList);
+    total += measure_traversal(freeList);
+    std::cout << "Total time: " << total << "\n\n";
+
+    return total;
+}
+
+template<size_t Bytes>
+void compare_storage(size_t count) {
+    double interleaved = measure_storage<Payload<Bytes>, InterleavedStorage>("InterleavedStorage", count);
+    double split = measure_storage<Payload<Bytes>, SplitStorage>("SplitStorage", count);
+
+    std::cout << "SplitStorage was " << (interleaved / split) << " times faster\n\n";
+}
+
+void test_storage_performance() {
+    const size_t count = 4000000;
+
+    compare_storage<64>(count);
+    compare_storage<256>(count);
+}
+
+template<typename Storage>
+double measure_growth(const char* name, size_t count) {
+    FreeList<int, uint32_t, Storage> freeList;
+    std::chrono::duration<double> worst(0);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        auto pushStart = std::chrono::high_resolution_clock::now();
+        freeList.push_back(static_cast<int>(i));
+        auto pushEnd = std::chrono::high_resolution_clock::now();
+        worst = std::max<std::chrono::duration<double>>(worst, pushEnd - pushStart);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+
+    std::cout << name << " without reserve()\n";
+    std::cout << "Insertion time: " << duration.count() << " seconds\n";
+    std::cout << "Worst single push_back: " << worst.count() << " seconds\n\n";
+
+    return worst.count();
+}
+
+void test_growth_performance() {
+    const size_t count = 100000000;
+
+    double contiguous = measure_growth<InterleavedStorage>("InterleavedStorage", count);
+    double chunked = measure_growth<ChunkedStorage<16>>("ChunkedStorage<16>", count);
+
+    std::cout << "ChunkedStorage worst-case push_back was " << (contiguous / chunked) << " times shorter\n\n";
+}
+
+template<typename Container>
+double measure_range_erase(Container& container, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        container.push_back(static_cast<int>(i));
+    }
+
+    // Trim the older half of the list, then drop every odd element
+    auto middle = std::next(container.begin(), count / 2);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    container.erase(container.begin(), middle);
+    container.remove_if([](int x) { return x % 2 != 0; });
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << "Range erase time: " << duration.count() << " seconds\n";
+
+    return duration.count();
+}
+
+void test_erase_performance() {
+    const size_t count = 50000000;
+
+    std::list<int> stdList;
+    FreeList<int, uint32_t> freeList;
+    freeList.reserve(count);
+
+    std::cout << "Testing std::list range erase with count == " << count << "\n";
+    double listTime = measure_range_erase(stdList, count);
+
+    std::cout << "Testing FreeList range erase with count == " << count << "\n";
+    double freeListTime = measure_range_erase(freeList, count);
+
+    assert(std::equal(freeList.begin(), freeList.end(), stdList.begin(), stdList.end()));
+
+    std::cout << "FreeList was " << (listTime / freeListTime) << " times faster\n\n";
+}
+
+template<typename Container>
+double measure_batch_insert(Container& container, const std::vector<int>& batch, size_t batches, bool bulk) {
+    container.push_back(-1);
+    auto pos = container.begin();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < batches; ++i) {
+        if (bulk) {
+            container.insert(pos, batch.begin(), batch.end());
+        } else {
+            for (const int x : batch) {
+                container.insert(pos, x);
+            }
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << "Batch insertion time: " << duration.count() << " seconds\n";
+
+    return duration.count();
+}
+
+void test_bulk_insert_performance() {
+    const size_t batches = 2000;
+    std::vector<int> batch(20000);
+    std::iota(batch.begin(), batch.end(), 0);
+
+    std::list<int> stdList;
+    FreeList<int, uint32_t> perElement;
+    FreeList<int, uint32_t> bulk;
+
+    std::cout << "Inserting " << batches << " batches of " << batch.size() << " records\n";
+    std::cout << "std::list range insert\n";
+    double listTime = measure_batch_insert(stdList, batch, batches, true);
+    std::cout << "FreeList element by element\n";
+    double perElementTime = measure_batch_insert(perElement, batch, batches, false);
+    std::cout << "FreeList range insert\n";
+    double bulkTime = measure_batch_insert(bulk, batch, batches, true);
+
+    assert(std::equal(bulk.begin(), bulk.end(), stdList.begin(), stdList.end()));
+
+    std::cout << "FreeList range insert was " << (listTime / bulkTime) << " times faster than std::list and "
+              << (perElementTime / bulkTime) << " times faster than single inserts\n\n";
+}
+
+// Runs `cycles` rounds of erasing and re-inserting a batch of elements at
+// random list positions, then times a full traversal of the result.
+template<typename SlotPolicy>
+double measure_churn(const char* name, size_t count, size_t cycles, size_t batch) {
+    std::mt19937 gen(42);
+    using List = FreeList<Payload<64>, uint32_t, InterleavedStorage, SlotPolicy>;
+    List freeList;
+    freeList.reserve(count);
+
+    std::vector<typename List::iterator> live;
+    live.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        freeList.push_back(Payload<64>(static_cast<int>(i)));
+        live.push_back(std::prev(freeList.end()));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t done = 0; done < cycles; done += batch) {
+        for (size_t i = 0; i < batch; ++i) {
+            const size_t victim = gen() % live.size();
+            freeList.erase(live[victim]);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+        for (size_t i = 0; i < batch; ++i) {
+            auto pos = live[gen() % live.size()];
+            live.push_back(freeList.insert(pos, Payload<64>(static_cast<int>(i))));
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+
+    std::cout << name << "\n";
+    std::cout << "Churn time: " << duration.count() << " seconds\n";
+
+    start = std::chrono::high_resolution_clock::now();
+    long long sum = 0;
+    for (const auto& payload : freeList) {
+        sum += payload.key;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    duration = end - start;
+    std::cout << "Iteration time: " << duration.count() << " seconds (checksum " << sum << ")\n\n";
+
+    return duration.count();
+}
+
+void test_churn_performance() {
+    const size_t count = 1000000;
+    const size_t cycles = 1000000;
+    const size_t batch = 1000;
+
+    std::cout << "Churning " << count << " elements with " << cycles << " random erase/insert cycles\n";
+    double lifo = measure_churn<LifoSlots>("LifoSlots", count, cycles, batch);
+    double lowest = measure_churn<LowestFirstSlots>("LowestFirstSlots", count, cycles, batch);
+    double nearest = measure_churn<NearestSlots>("NearestSlots", count, cycles, batch);
+
+    std::cout << "Iteration after churn: LowestFirstSlots was " << (lifo / lowest)
+              << " and NearestSlots " << (lifo / nearest) << " times faster than LifoSlots\n\n";
+}
+
+// Times one labelled pass over a container; `traverse(sum)` accumulates a
+// checksum so the pass cannot be optimised away.
+template<typename Traverse>
+double measure_pass(const char* name, Traverse traverse) {
+    long long sum = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    traverse(sum);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << name << " time: " << duration.count() << " seconds (checksum " << sum << ")\n";
+
+    return duration.count();
+}
+
+// Sums every byte of the payload, so each visit has to pull in all of its
+// cache lines.
+template<size_t Bytes>
+long long payload_checksum(const Payload<Bytes>& payload) {
+    long long sum = payload.key;
+    for (const char c : payload.padding) {
+        sum += c;
+    }
+    return sum;
+}
+
+template<size_t Bytes, typename Storage>
+void compare_prefetch(const char* name, size_t count) {
+    using Value = Payload<Bytes>;
+    std::mt19937 gen(42);
+    FreeList<Value, uint32_t, Storage> freeList;
+    freeList.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        freeList.push_back(Value(static_cast<int>(gen())));
+    }
+    // Random keys scatter list order across storage
+    freeList.sort();
+
+    std::cout << name << " with " << count << " fragmented " << sizeof(Value) << "-byte payloads\n";
+
+    double plain = measure_pass("Iterator loop", [&](long long& sum) {
+        for (const Value& v : freeList) {
+            sum += payload_checksum(v);
+        }
+    });
+    double grouped = measure_pass("for_each", [&](long long& sum) {
+        freeList.for_each([&sum](const Value& v) { sum += payload_checksum(v); });
+    });
+    double prefetched = measure_pass("for_each_prefetch(16)", [&](long long& sum) {
+        freeList.for_each_prefetch([&sum](const Value& v) { sum += payload_checksum(v); }, 16);
+    });
+    double adapter = measure_pass("prefetched(16) loop", [&](long long& sum) {
+        for (const Value& v : freeList.prefetched(16)) {
+            sum += payload_checksum(v);
+        }
+    });
+
+    std::cout << "Speedup over the iterator loop: for_each " << (plain / grouped)
+              << ", for_each_prefetch " << (plain / prefetched)
+              << ", prefetched() " << (plain / adapter) << "\n\n";
+}
+
+void test_prefetch_performance() {
+    // Both working sets are far beyond any L3 cache
+    const size_t count = 4000000;
+
+    compare_prefetch<64, InterleavedStorage>("InterleavedStorage", count);
+    compare_prefetch<64, SplitStorage>("SplitStorage", count);
+    compare_prefetch<256, SplitStorage>("SplitStorage", count);
+}
+
+template<typename Storage>
+void compare_scans(const char* name, size_t count) {
+    std::mt19937 gen(42);
+    FreeList<long long, uint32_t, Storage> freeList;
+    freeList.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        freeList.push_back(static_cast<long long>(gen() % count));
+    }
+    // Scatter list order across storage and leave a few holes behind
+    freeList.sort();
+    freeList.remove_if([](long long x) { return x % 97 == 0; });
+
+    std::cout << name << " with " << freeList.size() << " elements\n";
+
+    // -1 is never present, so both lookups scan everything
+    double linked = measure_pass("find", [&](long long& sum) {
+        sum += (freeList.find(-1) == freeList.end());
+        sum += std::accumulate(freeList.begin(), freeList.end(), 0LL);
+    });
+    double dense = measure_pass("find_unordered", [&](long long& sum) {
+        sum += (freeList.find_unordered(-1) == freeList.end());
+        sum += freeList.sum();
+    });
+
+    std::cout << "Storage-order find and sum were " << (linked / dense) << " times faster\n\n";
+}
+
+void test_scan_performance() {
+    const size_t count = 10000000;
+
+    compare_scans<InterleavedStorage>("InterleavedStorage", count);
+    compare_scans<SplitStorage>("SplitStorage", count);
+}
+
+#ifdef FREELIST_PARALLEL_SORT
+void test_parallel_sort_performance() {
+    const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (const size_t count : {10000000ul, 100000000ul}) {
+        std::cout << "Sorting with count == " << count << "\n";
+
+        auto fill = [count](auto& container) {
+            std::mt19937 gen(42);
+            std::uniform_int_distribution<int> dist;
+            for (size_t i = 0; i < count; ++i) {
+                container.push_back(dist(gen));
+            }
+        };
+
+        double listTime;
+        {
+            std::list<int> stdList;
+            fill(stdList);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            stdList.sort();
+            auto end = std::chrono::high_resolution_clock::now();
+            listTime = std::chrono::duration<double>(end - start).count();
+            std::cout << "std::list::sort time: " << listTime << " seconds\n";
+        }
+
+        {
+            FreeList<int> freeList;
+            freeList.reserve(count);
+            fill(freeList);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            freeList.sort();
+            auto end = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> duration = end - start;
+            std::cout << "FreeList::sort time: " << duration.count() << " seconds\n";
+        }
+
+        for (size_t threads = 1; threads <= hardwareThreads; threads *= 2) {
+            tbb::global_control limit(tbb::global_control::max_allowed_parallelism, threads);
+
+            FreeList<int> freeList;
+            freeList.reserve(count);
+            fill(freeList);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            freeList.sort(std::execution::par);
+            auto end = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> duration = end - start;
+
+            assert(std::is_sorted(freeList.begin(), freeList.end()));
+            std::cout << "FreeList::sort(par) with " << threads << " threads time: " << duration.count()
+                      << " seconds, " << (listTime / duration.count()) << " times faster than std::list\n";
+        }
+
+        std::cout << "\n";
+    }
+}
+#endif
+
+template<typename Generate>
+void compare_radix_sort(const char* name, size_t count, Generate generate) {
+    FreeList<int> merged;
+    FreeList<int> radix;
+    merged.reserve(count);
+    radix.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const int t = generate();
+        merged.push_back(t);
+        radix.push_back(t);
+    }
+
+    std::cout << "Sorting " << name << " keys with count == " << count << "\n";
+
+    // A comparator other than std::less keeps sort() on the merge sort
+    auto start = std::chrono::high_resolution_clock::now();
+    merged.sort([](int a, int b) { return a < b; });
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> mergeTime = end - start;
+    std::cout << "Merge sort time: " << mergeTime.count() << " seconds\n";
+
+    start = std::chrono::high_resolution_clock::now();
+    radix.sort();
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> radixTime = end - start;
+    std::cout << "Radix sort time: " << radixTime.count() << " seconds\n";
+
+    assert(std::equal(merged.begin(), merged.end(), radix.begin(), radix.end()));
+
+    std::cout << "Radix sort was " << (mergeTime.count() / radixTime.count()) << " times faster\n\n";
+}
+
+void test_radix_sort_performance() {
+    const size_t count = 10000000;
+    std::mt19937 gen(42);
+
+    std::uniform_int_distribution<int> uniform;
+    compare_radix_sort("uniform", count, [&] { return uniform(gen); });
+
+    // Most keys are small, so the upper bytes are shared and skipped
+    std::geometric_distribution<int> skewed(0.001);
+    compare_radix_sort("skewed", count, [&] { return skewed(gen); });
+}
+
+// Builds many small lists per request and throws them all away, the
+// pattern monotonic arenas are meant for.
+template<typename MakeList>
+double measure_build_discard(const char* name, size_t requests, MakeList makeList) {
+    long long sum = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t request = 0; request < requests; ++request) {
+        sum += makeList();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << name << " time: " << duration.count() << " seconds (checksum " << sum << ")\n";
+
+    return duration.count();
+}
+
+template<typename Lists>
+long long build_lists(Lists& lists) {
+    long long sum = 0;
+
+    for (size_t i = 0; i < lists.size(); ++i) {
+        for (int x = 0; x < 64; ++x) {
+            lists[i].push_back(x);
+        }
+        lists[i].remove_if([](int x) { return x % 4 == 0; });
+        sum += lists[i].size();
+    }
+
+    return sum;
+}
+
+void test_pmr_performance() {
+    const size_t requests = 20000;
+    const size_t listsPerRequest = 100;
+
+    std::cout << "Building and discarding " << listsPerRequest << " lists of 64 ints per request, "
+              << requests << " requests\n";
+
+    double heap = measure_build_discard("std::allocator", requests, [&] {
+        std::vector<FreeList<int, uint32_t>> lists(listsPerRequest);
+        return build_lists(lists);
+    });
+
+    std::vector<std::byte> buffer(1 << 20);
+    double arena = measure_build_discard("monotonic_buffer_resource", requests, [&] {
+        pmr::monotonic_buffer_resource monotonic(buffer.data(), buffer.size());
+        pmr::vector<PmrFreeList<int, uint32_t>> lists(listsPerRequest, &monotonic);
+        return build_lists(lists);
+    });
+
+    std::cout << "monotonic_buffer_resource was " << (heap / arena) << " times faster\n\n";
+}
+
+// Runs a skewed get/put mix on a cache whose lists draw from a counting
+// resource, so allocations by the buckets and the frequency list show up.
+template<typename Cache>
+double measure_lfu_workload(const char* name, size_t operations) {
+    CountingResource resource;
+    Cache cache(10000, &resource);
+    std::mt19937 gen(42);
+    std::geometric_distribution<int> keys(0.0002);
+    long long hits = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < operations; ++i) {
+        int key = keys(gen);
+        if (!cache.get(key)) {
+            cache.put(key, static_cast<int>(i));
+        } else {
+            hits++;
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << name << " time: " << duration.count() << " seconds, " << resource.allocations
+              << " allocations, " << resource.bytes / 1024 << " KiB held (hits " << hits << ")\n";
+
+    return duration.count();
+}
+
+// Creates and drops a bucket holding `entries` keys, the pattern get()
+// and put() follow whenever a key moves to a frequency no other key has.
+template<typename Bucket>
+double measure_bucket_churn(const char* name, size_t buckets, int entries) {
+    CountingResource resource;
+    long long sum = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < buckets; ++i) {
+        Bucket bucket(&resource);
+        for (int k = 0; k < entries; ++k) {
+            bucket.emplace_back(k, static_cast<int>(i));
+        }
+        sum += bucket.back().second;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << name << " time: " << duration.count() << " seconds, " << resource.allocations
+              << " allocations (checksum " << sum << ")\n";
+
+    return duration.count();
+}
+
+void test_lfu_bucket_performance() {
+    using HeapBucket = PmrFreeList<pair<int,int>>;
+    using SmallBucket = SmallFreeList<pair<int,int>, 4, size_t, LifoSlots, pmr::polymorphic_allocator<pair<int,int>>>;
+
+    const size_t buckets = 1000000;
+    for (int entries : {1, 3, 8}) {
+        std::cout << "Creating and destroying " << buckets << " buckets of " << entries << " entries\n";
+        double heap = measure_bucket_churn<HeapBucket>("FreeList bucket", buckets, entries);
+        double small = measure_bucket_churn<SmallBucket>("SmallFreeList<4> bucket", buckets, entries);
+        std::cout << "SmallFreeList<4> was " << (heap / small) << " times faster\n\n";
+    }
+
+    const size_t operations = 2000000;
+    std::cout << "LFUCache(10000), " << operations << " get-or-put operations on skewed keys\n";
+    double heap = measure_lfu_workload<BasicLFUCache<int, int, std::hash<int>, HeapBucket>>("FreeList buckets", operations);
+    double small = measure_lfu_workload<BasicLFUCache<int, int>>("SmallFreeList<4> buckets", operations);
+    std::cout << "SmallFreeList<4> buckets were " << (heap / small) << " times faster\n\n";
+}
+
+// LFUCache as it was before the flat index: two node-based maps from each
+// key to its bucket and to its entry, hashed up to five times per call.
+// Kept to measure the index against; its maps draw from the cache's
+// resource so their memory is counted as well.
+class MapIndexLFUCache {
+private:
+    using Bucket = SmallFreeList<pair<int,int>, 4, size_t, LifoSlots, pmr::polymorphic_allocator<pair<int,int>>>;
+
+    struct Node {
+        using allocator_type = pmr::polymorphic_allocator<pair<int,int>>;
+
+        Bucket data;
+        int freq;
+        Node(int f, const allocator_type& alloc) : data(alloc), freq(f) {}
+        Node(Node&& other, const allocator_type& alloc) : data(std::move(other.data), alloc), freq(other.freq) {}
+    };
+
+    PmrFreeList<Node> nodeList;
+    pmr::unordered_map<int, PmrFreeList<Node>::iterator> keyLFU;
+    pmr::unordered_map<int, Bucket::iterator> keyLRU;
+    int cap;
+    int size;
+
+public:
+    MapIndexLFUCache(int capacity, pmr::memory_resource* resource)
+        : nodeList(resource), keyLFU(resource), keyLRU(resource), cap(capacity), size(0) {
+        nodeList.reserve(cap+1);
+    }
+
+    std::optional<int> get(int key) {
+        const auto it = keyLFU.find(key);
+
+        if (it == keyLFU.end()) return std::nullopt;
+
+        const auto currIt = it->second;
+        const auto nextIt = next(currIt);
+        const auto [_, value] = *keyLRU[key];
+
+        const auto listIt = (nextIt == nodeList.end() || nextIt->freq != (currIt->freq+1))
+            ? nodeList.emplace(nextIt, currIt->freq+1)
+            : nextIt;
+
+        currIt->data.erase(keyLRU[key]);
+        if (currIt->data.empty()) {
+            nodeList.erase(currIt);
+        }
+
+        keyLRU[key] = listIt->data.insert(listIt->data.end(), {key,value});
+        keyLFU[key] = listIt;
+
+        return value;
+    }
+
+    void put(int key, int value) {
+        if (cap == 0) return;
+
+        const auto it = keyLFU.find(key);
+
+        if (it == keyLFU.end()) {
+            if (size == cap) {
+                auto LFU = nodeList.begin();
+                auto [k,_] = LFU->data.front();
+                LFU->data.pop_front();
+                keyLRU.erase(k);
+                keyLFU.erase(k);
+
+                if (LFU->data.empty()) {
+                    nodeList.erase(LFU);
+                }
+
+                size--;
+            }
+
+            const auto listIt = (nodeList.empty() || nodeList.begin()->freq != 1)
+                ? nodeList.emplace(nodeList.begin(), 1)
+                : nodeList.begin();
+
+            keyLRU[key] = listIt->data.insert(listIt->data.end(), {key, value});
+            keyLFU[key] = listIt;
+            size++;
+
+            return;
+        }
+
+        const auto currIt = it->second;
+        const auto listIt = (next(currIt) == nodeList.end() || next(currIt)->freq != (currIt->freq+1))
+            ? nodeList.emplace(next(currIt), currIt->freq+1)
+            : next(currIt);
+
+        currIt->data.erase(keyLRU[key]);
+        if (currIt->data.empty()) {
+            nodeList.erase(currIt);
+        }
+
+        keyLRU[key] = listIt->data.insert(listIt->data.end(), {key,value});
+        keyLFU[key] = listIt;
+    }
+};
+
+// Lookup latency alone: every key of a full cache is read back in random
+// order, so each get() hits and moves its key up one frequency
+template<typename Cache>
+double measure_lfu_hits(const char* name, int capacity, size_t rounds) {
+    CountingResource resource;
+    Cache cache(capacity, &resource);
+    std::vector<int> keys(capacity);
+    std::iota(keys.begin(), keys.end(), 0);
+    for (int key : keys) {
+        cache.put(key * 7919, key);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+    long long sum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t round = 0; round < rounds; ++round) {
+        for (int key : keys) {
+            sum += *cache.get(key * 7919);
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    double perOp = duration.count() * 1e9 / (rounds * keys.size());
+    std::cout << name << ": " << perOp << " ns/get, " << static_cast<double>(resource.bytes) / capacity
+              << " bytes per key (checksum " << sum << ")\n";
+
+    return perOp;
+}
+
+void test_lfu_index_performance() {
+    for (int capacity : {1000, 100000, 1000000}) {
+        size_t rounds = 10000000 / capacity;
+        std::cout << "LFUCache(" << capacity << "), every key read back " << rounds << " times\n";
+        double maps = measure_lfu_hits<MapIndexLFUCache>("Two unordered_maps", capacity, rounds);
+        double flat = measure_lfu_hits<BasicLFUCache<int, int>>("Flat index", capacity, rounds);
+        std::cout << "The flat index was " << (maps / flat) << " times faster\n\n";
+    }
+
+    const size_t operations = 2000000;
+    std::cout << "LFUCache(10000), " << operations << " get-or-put operations on skewed keys\n";
+    double maps = measure_lfu_workload<MapIndexLFUCache>("Two unordered_maps", operations);
+    double flat = measure_lfu_workload<BasicLFUCache<int, int>>("Flat index", operations);
+    std::cout << "The flat index was " << (maps / flat) << " times faster\n\n";
+}
+
+// FreeList shared between threads the only way it can be: one mutex taken
+// around every allocation and release.
+class LockedFreeList {
+public:
+    using Index = FreeList<long long>::iterator;
+
+    Index emplace(long long value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return list.emplace(list.cend(), value);
+    }
+
+    void erase(Index index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        list.erase(index);
+    }
+
+    long long& operator[](Index index) { return *index; }
+
+private:
+    std::mutex mutex;
+    FreeList<long long> list;
+};
+
+// Every thread repeatedly takes a batch of 16 objects from the shared pool,
+// touches them and gives them back. Each thread goes through its own
+// `Front`, either the pool itself or a per-thread cache over it.
+template<typename Pool, typename Front = Pool&>
+double measure_pool_churn(const char* name, size_t threads, size_t operations) {
+    Pool pool;
+    std::atomic<long long> checksum(0);
+    std::vector<std::thread> workers;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            Front front(pool);
+            std::vector<typename Pool::Index> held;
+            long long sum = 0;
+
+            for (size_t op = 0; op < operations / threads; ++op) {
+                held.push_back(front.emplace(static_cast<long long>(t + op)));
+                if (held.size() == 16) {
+                    for (auto index : held) {
+                        sum += front[index];
+                        front.erase(index);
+                    }
+                    held.clear();
+                }
+            }
+            for (auto index : held) {
+                front.erase(index);
+            }
+            checksum += sum;
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << name << " with " << threads << " threads time: " << duration.count()
+              << " seconds (checksum " << checksum << ")\n";
+
+    return duration.count();
+}
+
+void test_concurrent_pool_performance() {
+    const size_t operations = 4000000;
+    const size_t maxThreads = std::max<size_t>(4, std::thread::hardware_concurrency());
+
+    std::cout << "Allocating and releasing " << operations << " pooled objects across threads\n";
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        double locked = measure_pool_churn<LockedFreeList>("mutex + FreeList", threads, operations);
+        double lockFree = measure_pool_churn<ConcurrentFreeList<long long>>("ConcurrentFreeList", threads, operations);
+        std::cout << "ConcurrentFreeList was " << (locked / lockFree) << " times faster\n\n";
+    }
+}
+
+// Bounded single-producer single-consumer queue of slot indices
+template<typename Value, size_t Capacity = 1024>
+class HandoffQueue {
+public:
+    void push(Value value) {
+        size_t tail = tailPos.load(std::memory_order_relaxed);
+        while (tail - headPos.load(std::memory_order_acquire) == Capacity) {
+            std::this_thread::yield();
+        }
+        items[tail % Capacity] = value;
+        tailPos.store(tail + 1, std::memory_order_release);
+    }
+
+    Value pop() {
+        size_t head = headPos.load(std::memory_order_relaxed);
+        while (tailPos.load(std::memory_order_acquire) == head) {
+            std::this_thread::yield();
+        }
+        Value value = items[head % Capacity];
+        headPos.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+private:
+    Value items[Capacity];
+    alignas(64) std::atomic<size_t> headPos{0};
+    alignas(64) std::atomic<size_t> tailPos{0};
+};
+
+// Producer threads allocate objects and hand them to a paired consumer
+// thread, which reads and frees them, so every free is a cross-thread free
+template<typename Pool, typename Front = Pool&>
+double measure_producer_consumer(const char* name, size_t pairs, size_t operations) {
+    Pool pool;
+    std::vector<HandoffQueue<typename Pool::Index>> queues(pairs);
+    std::atomic<long long> checksum(0);
+    std::vector<std::thread> workers;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t p = 0; p < pairs; ++p) {
+        workers.emplace_back([&, p] {
+            Front front(pool);
+            for (size_t op = 0; op < operations / pairs; ++op) {
+                queues[p].push(front.emplace(static_cast<long long>(op)));
+            }
+        });
+        workers.emplace_back([&, p] {
+            Front front(pool);
+            long long sum = 0;
+            for (size_t op = 0; op < operations / pairs; ++op) {
+                auto index = queues[p].pop();
+                sum += front[index];
+                front.erase(index);
+            }
+            checksum += sum;
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << name << " with " << pairs << " producer/consumer pairs time: " << duration.count()
+              << " seconds (checksum " << checksum << ")\n";
+
+    return duration.count();
+}
+
+void test_magazine_performance() {
+    using Pool = ConcurrentFreeList<long long>;
+
+    const size_t operations = 4000000;
+    const size_t maxThreads = std::max<size_t>(4, std::thread::hardware_concurrency());
+
+    std::cout << "All threads churning " << operations << " pooled objects\n";
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        double shared = measure_pool_churn<Pool>("shared free chain", threads, operations);
+        double cached = measure_pool_churn<Pool, Pool::Magazine>("per-thread Magazines", threads, operations);
+        std::cout << "Magazines were " << (shared / cached) << " times faster\n\n";
+    }
+
+    std::cout << "Producers handing " << operations << " pooled objects to consumers\n";
+    for (size_t pairs = 1; pairs <= maxThreads / 2; pairs *= 2) {
+        double shared = measure_producer_consumer<Pool>("shared free chain", pairs, operations);
+        double cached = measure_producer_consumer<Pool, Pool::Magazine>("per-thread Magazines", pairs, operations);
+        std::cout << "Magazines were " << (shared / cached) << " times faster\n\n";
+    }
+}
+
+// Zipf-distributed integers in [0, n): rank k is drawn with probability
+// proportional to 1 / (k + 1)^skew, sampled by binary search on the CDF
+class ZipfKeys {
+public:
+    ZipfKeys(size_t n, double skew) : cdf(n) {
+        double sum = 0;
+        for (size_t k = 0; k < n; ++k) {
+            sum += 1.0 / std::pow(static_cast<double>(k + 1), skew);
+            cdf[k] = sum;
+        }
+        for (double& c : cdf) {
+            c /= sum;
+        }
+    }
+
+    template<typename Generator>
+    int operator()(Generator& gen) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+        return static_cast<int>(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+    }
+
+private:
+    std::vector<double> cdf;
+};
+
+// Baseline for the sharded cache: one LFUCache behind one lock
+class LockedLFUCache {
+public:
+    LockedLFUCache(int capacity, size_t) : cache(capacity) {}
+
+    std::optional<int> get(int key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cache.get(key);
+    }
+
+    void put(int key, int value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cache.put(key, value);
+    }
+
+private:
+    std::mutex mutex;
+    BasicLFUCache<int, int> cache;
+};
+
+// Every thread runs get-or-put on Zipfian keys; returns operations/second
+template<typename Cache>
+double measure_cache_throughput(const char* name, size_t threads, size_t operations,
+                                const std::vector<std::vector<int>>& keys) {
+    Cache cache(10000, 2 * threads);
+    std::atomic<size_t> hits(0);
+    std::vector<std::thread> workers;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            const std::vector<int>& mine = keys[t];
+            size_t local = 0;
+            for (size_t op = 0; op < operations / threads; ++op) {
+                int key = mine[op % mine.size()];
+                if (cache.get(key)) {
+                    local++;
+                } else {
+                    cache.put(key, key);
+                }
+            }
+            hits += local;
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    double rate = operations / duration.count();
+    std::cout << name << " with " << threads << " threads: " << rate << " ops/sec (hits " << hits << ")\n";
+
+    return rate;
+}
+
+void test_sharded_lfu_performance() {
+    const size_t operations = 2000000;
+    const size_t maxThreads = std::max<size_t>(4, std::thread::hardware_concurrency());
+
+    // Keys are drawn up front so the generator stays out of the timing
+    ZipfKeys zipf(100000, 0.99);
+    std::vector<std::vector<int>> keys(maxThreads);
+    for (size_t t = 0; t < maxThreads; ++t) {
+        std::mt19937 gen(static_cast<unsigned>(t + 1));
+        for (size_t i = 0; i < (1 << 18); ++i) {
+            keys[t].push_back(zipf(gen));
+        }
+    }
+
+    std::cout << "Cache of 10000 over 100000 Zipfian keys (skew 0.99), " << operations << " get-or-put operations\n";
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        double locked = measure_cache_throughput<LockedLFUCache>("single lock", threads, operations, keys);
+        double sharded = measure_cache_throughput<ShardedLFUCache<int, int>>("ShardedLFUCache", threads, operations, keys);
+        std::cout << "ShardedLFUCache sustained " << (sharded / locked) << " times the throughput\n\n";
+    }
+}
+
+// Read-mostly traffic on a warm cache: 1 in 20 operations is a write
+template<typename Cache>
+double measure_read_mostly(const char* name, Cache& cache, size_t threads, size_t operations,
+                           const std::vector<std::vector<int>>& keys) {
+    std::atomic<size_t> hits(0);
+    std::vector<std::thread> workers;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            const std::vector<int>& mine = keys[t];
+            size_t local = 0;
+            for (size_t op = 0; op < operations / threads; ++op) {
+                int key = mine[op % mine.size()];
+                if (op % 20 == 0) {
+                    cache.put(key, key);
+                } else if (cache.get(key)) {
+                    local++;
+                }
+            }
+            hits += local;
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    double rate = operations / duration.count();
+    std::cout << name << " with " << threads << " threads: " << rate << " ops/sec, "
+              << (duration.count() * 1e9 * threads / operations) << " ns/op (hits " << hits << ")\n";
+
+    return rate;
+}
+
+void test_buffered_hits_performance() {
+    const size_t operations = 4000000;
+    const size_t maxThreads = std::max<size_t>(4, std::thread::hardware_concurrency());
+
+    ZipfKeys zipf(20000, 0.99);
+    std::vector<std::vector<int>> keys(maxThreads);
+    for (size_t t = 0; t < maxThreads; ++t) {
+        std::mt19937 gen(static_cast<unsigned>(t + 1));
+        for (size_t i = 0; i < (1 << 18); ++i) {
+            keys[t].push_back(zipf(gen));
+        }
+    }
+
+    // Plain hash map reads set the bar for the read path
+    std::unordered_map<int, int> map;
+    for (int key = 0; key < 20000; ++key) {
+        map[key] = key;
+    }
+    long long sum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t op = 0; op < operations; ++op) {
+        sum += map.find(keys[0][op % keys[0].size()])->second;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << "unordered_map::find: " << (duration.count() * 1e9 / operations) << " ns/op (checksum " << sum << ")\n\n";
+
+    std::cout << "Cache of 10000 over 20000 Zipfian keys, 95% reads, " << operations << " operations\n";
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        ShardedLFUCache<int, int> exact(10000, 2 * threads);
+        ShardedLFUCache<int, int> buffered(10000, 2 * threads, pmr::get_default_resource(), LFUHitPolicy::buffered);
+        for (int key = 0; key < 20000; ++key) {
+            exact.put(key, key);
+            buffered.put(key, key);
+        }
+
+        double exactRate = measure_read_mostly("exact hits", exact, threads, operations, keys);
+        double bufferedRate = measure_read_mostly("buffered hits", buffered, threads, operations, keys);
+        std::cout << "Buffered hits sustained " << (bufferedRate / exactRate) << " times the throughput\n\n";
+    }
+}
+
+void test_sort_performance() {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist;
+
+    for (const size_t count : {1000000ul, 10000000ul, 100000000ul}) {
+        std::list<int> stdList;
+        FreeList<int> freeList;
+        freeList.reserve(count);
+
+        for (size_t i = 0; i < count; ++i) {
+            const int t = dist(gen);
+            stdList.push_back(t);
+            freeList.push_back(t);
+        }
+
+        std::cout << "Sorting with count == " << count << "\n";
+
+        auto start = std::chrono::high_resolution_clock::now();
+        stdList.sort();
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> listTime = end - start;
+        std::cout << "std::list::sort time: " << listTime.count() << " seconds\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        freeList.sort();
+        end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> freeListTime = end - start;
+        std::cout << "FreeList::sort time: " << freeListTime.count() << " seconds\n";
+
+        assert(std::equal(freeList.begin(), freeList.end(), stdList.begin(), stdList.end()));
+
+        std::cout << "FreeList::sort was " << (listTime.count() / freeListTime.count()) << " times faster\n\n";
+    }
+}
+
 int main() {
     test_mergeSort();
+    test_sortRange();
+    test_compact();
+    test_freeChain();
+    test_indexType();
+    test_splitStorage();
+    test_chunkedStorage();
+    test_payloadLifetime();
+    test_emplace();
+    test_listOperations();
+    test_rangeErase();
+    test_bulkInsert();
+    test_slotPolicies();
+    test_prefetchTraversal();
+    test_unorderedScans();
+#ifdef FREELIST_PARALLEL_SORT
+    test_parallelSort();
+#endif
+    test_radixSort();
+    test_handles();
+    test_allocators();
+    test_inplaceFreeList();
+    test_smallFreeList();
+    test_concurrentFreeList();
+    test_magazines();
     test_LFUCache();
+    test_shardedLFUCache();
     test_STL_functions();
     test_performance();
+    test_sort_performance();
+    test_storage_performance();
+    test_growth_performance();
+    test_erase_performance();
+    test_bulk_insert_performance();
+    test_churn_performance();
+    test_prefetch_performance();
+    test_scan_performance();
+#ifdef FREELIST_PARALLEL_SORT
+    test_parallel_sort_performance();
+#endif
+    test_radix_sort_performance();
+    test_pmr_performance();
+    test_lfu_bucket_performance();
+    test_lfu_index_performance();
+    test_concurrent_pool_performance();
+    test_magazine_performance();
+    test_sharded_lfu_performance();
+    test_buffered_hits_performance();
     return 0;
 }
 